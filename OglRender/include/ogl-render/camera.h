@@ -27,6 +27,16 @@ static const float SPEED = 2.5f;
 static const float SENSITIVITY = 0.1f;
 static const float ZOOM = 45.0f;
 static const float PI = 3.1415926;
+
+// what the programs of a frame share of the camera, laid out as the std140 block
+//   layout (std140) uniform Camera { mat4 view; mat4 projection; mat4 viewProjection; };
+// to be uploaded once per frame through a UniformBlock<CameraMatrices> (ogl-render/uniform-block.h)
+struct CameraMatrices {
+  glm::mat4 view;
+  glm::mat4 projection;
+  glm::mat4 viewProjection;
+};
+
 class PerspectiveCamera {
   public:
     PerspectiveCamera(float fov = ZOOM, float sensitivity = SENSITIVITY)
@@ -42,7 +52,23 @@ class PerspectiveCamera {
     virtual glm::mat4 getViewMatrix() const = 0;
     virtual glm::mat4 getProjectionMatrix(float width, float height) const = 0;
 
-    void setFOV(float fov_) { fov = fov_; }
+    // recomputed only after the camera moved or the viewport changed size
+    const CameraMatrices& matrices(float width, float height) {
+      if (dirty || width != cachedWidth || height != cachedHeight) {
+        cached.view = getViewMatrix();
+        cached.projection = getProjectionMatrix(width, height);
+        cached.viewProjection = cached.projection * cached.view;
+        cachedWidth = width;
+        cachedHeight = height;
+        dirty = false;
+      }
+      return cached;
+    }
+
+    void setFOV(float fov_) {
+      fov = fov_;
+      dirty = true;
+    }
     float getFOV() const { return fov; }
 
     void setSensitivity(float sensitivity_) { sensitivity = sensitivity_; }
@@ -52,6 +78,12 @@ class PerspectiveCamera {
   protected:
     float fov;
     float sensitivity;
+    // set by whatever changes the view or the projection
+    bool dirty = true;
+
+  private:
+    CameraMatrices cached{};
+    float cachedWidth = 0.0f, cachedHeight = 0.0f;
 };
 
 // An camera class that processes input and calculates the corresponding Euler Angles, Vectors and Matrices for use in OpenGL
@@ -68,6 +100,7 @@ class FpsCamera : public PerspectiveCamera {
 
     void processKeyBoard(GLFWwindow* window, float deltaTime) override {
       float cameraSpeed = movementSpeed * deltaTime;
+      glm::vec3 start = position;
       if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
         position += front * cameraSpeed;
       if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
@@ -76,6 +109,8 @@ class FpsCamera : public PerspectiveCamera {
         position -= glm::normalize(glm::cross(front, up)) * cameraSpeed;
       if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
         position += glm::normalize(glm::cross(front, up)) * cameraSpeed;
+      if (position != start)
+        dirty = true;
     }
 
     void processMouseMovement(float xoffset, float yoffset) override {
@@ -118,6 +153,7 @@ class FpsCamera : public PerspectiveCamera {
       newFront.y = sin(glm::radians(pitch));
       newFront.z = sin(glm::radians(yaw)) * cos(glm::radians(pitch));
       front = glm::normalize(newFront);
+      dirty = true;
     }
 };
 class TargetCamera : public PerspectiveCamera {
@@ -158,6 +194,7 @@ class TargetCamera : public PerspectiveCamera {
 
     void processMouseScroll(float yoffset) override {
       distance -= yoffset * sensitivity;
+      dirty = true;
     }
 
     glm::mat4 getViewMatrix() const override {
@@ -172,6 +209,8 @@ class TargetCamera : public PerspectiveCamera {
     }
   private:
     void updateCameraVectors() {
+      // called every frame with keys polled, the matrices only go stale when something moved
+      glm::vec3 lastPosition = position, lastUp = up;
       position.x = targetPosition.x + distance * cos(glm::radians(yaw)) * cos(
                        glm::radians(pitch));
       position.y = targetPosition.y + distance * sin(glm::radians(pitch));
@@ -183,6 +222,8 @@ class TargetCamera : public PerspectiveCamera {
       glm::vec3 right = glm::normalize(glm::cross(front, worldUp));
 
       up = glm::normalize(glm::cross(right, front));
+      if (position != lastPosition || up != lastUp)
+        dirty = true;
     }
     glm::vec3 targetPosition;
     float distance;
@@ -0,0 +1,50 @@
+#ifndef OGL_RENDER_INCLUDE_OGL_RENDER_GL_EXT_H_
+#define OGL_RENDER_INCLUDE_OGL_RENDER_GL_EXT_H_
+
+#include <glad/glad.h>
+
+// glad is generated for GL 3.3 core; what newer drivers (or extensions) offer beyond that is loaded here
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT 0x0080
+#define GL_DYNAMIC_STORAGE_BIT 0x0100
+#define GL_CLIENT_STORAGE_BIT 0x0200
+#endif
+
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+namespace opengl {
+typedef void (APIENTRYP PFNGLBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size, const void *data,
+                                                GLbitfield flags);
+typedef void (APIENTRYP PFNGLGETPROGRAMBINARYPROC)(GLuint program, GLsizei bufSize, GLsizei *length,
+                                                   GLenum *binaryFormat, void *binary);
+typedef void (APIENTRYP PFNGLPROGRAMBINARYPROC)(GLuint program, GLenum binaryFormat, const void *binary,
+                                                GLsizei length);
+typedef void (APIENTRYP PFNGLPROGRAMPARAMETERIPROC)(GLuint program, GLenum pname, GLint value);
+typedef void (APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint count);
+
+// entry points past GL 3.3, null when the driver has neither the GL version nor the extension
+struct GLExtensions {
+  // GL 4.4 or ARB_buffer_storage
+  PFNGLBUFFERSTORAGEPROC bufferStorage = nullptr;
+  // GL 4.1 or ARB_get_program_binary, and only when the driver offers a binary format
+  PFNGLGETPROGRAMBINARYPROC getProgramBinary = nullptr;
+  PFNGLPROGRAMBINARYPROC programBinary = nullptr;
+  PFNGLPROGRAMPARAMETERIPROC programParameteri = nullptr;
+  // KHR_parallel_shader_compile (or the ARB one): compiles and links run on driver threads until their status
+  // is queried
+  PFNGLMAXSHADERCOMPILERTHREADSKHRPROC maxShaderCompilerThreads = nullptr;
+};
+extern GLExtensions glext;
+
+// fills glext from the current context, after gladLoadGLLoader with the same loader
+void loadExtensions(GLADloadproc load);
+bool hasExtension(const char *name);
+bool hasVersion(int major, int minor);
+}
+
+#endif
@@ -0,0 +1,136 @@
+#ifndef OGL_RENDER_INCLUDE_OGL_RENDER_GL_STATE_H_
+#define OGL_RENDER_INCLUDE_OGL_RENDER_GL_STATE_H_
+
+#include <glad/glad.h>
+#include <array>
+#include <cstdint>
+
+namespace opengl {
+// what a context has bound, so that binding what already is costs no driver call
+// every bind()/use() of the wrappers goes through glstate(), the cache of the context current on the calling
+// thread: whoever makes a context current makes its cache current with it (makeCurrent()). A thread that never
+// does has a cache of its own, which is enough for one context. After binding with raw gl* calls, call reset().
+struct GLState {
+  struct Counters {
+    uint64_t issued = 0;
+    uint64_t skipped = 0;
+  };
+  static constexpr int kTextureUnits = 16;
+
+  // since endFrame(), of the last frame and of all frames
+  Counters frame, last, total;
+  uint64_t frames = 0;
+
+  GLState() {
+    reset();
+  }
+  GLState(const GLState &) = delete;
+  GLState &operator=(const GLState &) = delete;
+  // stops being the calling thread's cache
+  ~GLState();
+
+  // the cache of the context just made current on this thread
+  void makeCurrent();
+
+  void useProgram(GLuint id) {
+    if (change(program, id))
+      glUseProgram(id);
+  }
+  void bindVertexArray(GLuint id) {
+    if (change(vertex_array, id)) {
+      glBindVertexArray(id);
+      // the element buffer binding belongs to the vertex array
+      element_buffer = kUnknown;
+    }
+  }
+  void bindArrayBuffer(GLuint id) {
+    if (change(array_buffer, id))
+      glBindBuffer(GL_ARRAY_BUFFER, id);
+  }
+  void bindElementBuffer(GLuint id) {
+    if (change(element_buffer, id))
+      glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, id);
+  }
+  // the generic uniform buffer binding, for uploads; glBindBufferBase sets it as well
+  void bindUniformBuffer(GLuint id) {
+    if (change(uniform_buffer, id))
+      glBindBuffer(GL_UNIFORM_BUFFER, id);
+  }
+  void activeTexture(int unit) {
+    if (change(active_unit, static_cast<GLuint>(unit)))
+      glActiveTexture(GL_TEXTURE0 + unit);
+  }
+  // to the active unit when unit is negative, e.g. only to upload texels
+  void bindTexture2D(GLuint id, int unit = -1) {
+    if (unit >= 0)
+      activeTexture(unit);
+    if (active_unit >= static_cast<GLuint>(kTextureUnits)) {
+      glBindTexture(GL_TEXTURE_2D, id);
+      frame.issued++;
+      return;
+    }
+    if (change(textures[active_unit], id))
+      glBindTexture(GL_TEXTURE_2D, id);
+  }
+
+  // deleting an object unbinds it
+  void deletedProgram(GLuint id) {
+    // a program in use stays in use until another one is, whatever the cache says
+    if (program == id)
+      program = kUnknown;
+  }
+  void deletedVertexArray(GLuint id) {
+    if (vertex_array == id) {
+      vertex_array = 0;
+      element_buffer = kUnknown;
+    }
+  }
+  void deletedBuffer(GLuint id) {
+    if (array_buffer == id)
+      array_buffer = 0;
+    if (element_buffer == id)
+      element_buffer = 0;
+    if (uniform_buffer == id)
+      uniform_buffer = 0;
+  }
+  void deletedTexture(GLuint id) {
+    for (GLuint &texture : textures)
+      if (texture == id)
+        texture = 0;
+  }
+
+  // nothing is assumed to be bound
+  void reset() {
+    program = vertex_array = array_buffer = element_buffer = uniform_buffer = active_unit = kUnknown;
+    textures.fill(kUnknown);
+  }
+  // after the frame is presented
+  void endFrame() {
+    last = frame;
+    total.issued += frame.issued;
+    total.skipped += frame.skipped;
+    frames++;
+    frame = {};
+  }
+
+ private:
+  static constexpr GLuint kUnknown = ~GLuint{0};
+
+  bool change(GLuint &bound, GLuint id) {
+    if (bound == id) {
+      frame.skipped++;
+      return false;
+    }
+    bound = id;
+    frame.issued++;
+    return true;
+  }
+
+  GLuint program, vertex_array, array_buffer, element_buffer, uniform_buffer, active_unit;
+  std::array<GLuint, kTextureUnits> textures;
+};
+// the calling thread's current cache
+GLState &glstate();
+}
+
+#endif
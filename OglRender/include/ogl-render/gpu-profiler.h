@@ -0,0 +1,150 @@
+#ifndef OGL_RENDER_INCLUDE_OGL_RENDER_GPU_PROFILER_H_
+#define OGL_RENDER_INCLUDE_OGL_RENDER_GPU_PROFILER_H_
+
+#include <glad/glad.h>
+#include <ogl-render/ogl-ctx.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+#ifndef HCI_PROFILING
+#define HCI_PROFILING 1
+#endif
+
+namespace opengl {
+// GPU time of zones of GL commands, from a ring of GL_TIME_ELAPSED queries per frame that is read back Frames
+// frames after it was issued, so reading never waits for the GPU; a result still not there by then is dropped.
+// GL runs one such query at a time: zones do not nest, one opened inside another is not measured.
+// A zone is placed on the timeline where the GPU likely ran it: no earlier than it was submitted (on the
+// steady clock, as core::monotonicNs) nor than the zone before it ended.
+template<int Frames = 4, int ZonesPerFrame = 32>
+class GpuProfiler : NonCopyable {
+  public:
+    struct Result {
+      const char *name;
+      int64_t beginNs, endNs;
+    };
+
+    GpuProfiler() {
+      GLint bits = 0;
+      glGetQueryiv(GL_TIME_ELAPSED, GL_QUERY_COUNTER_BITS, &bits);
+      supported = bits > 0;
+      for (Slot &slot : slots)
+        glGenQueries(ZonesPerFrame, slot.queries.data());
+    }
+    // false without timer queries, zones then measure nothing
+    [[nodiscard]] bool available() const {
+      return supported;
+    }
+
+    // at the start of a frame; hands the zones of the frame Frames frames back to fn(const Result&)
+    template<typename Fn>
+    void beginFrame(Fn &&fn) {
+      current = (current + 1) % Frames;
+      read(slots[current], false, fn);
+    }
+    // everything still in flight, waiting for the GPU, e.g. before the trace is written
+    template<typename Fn>
+    void finish(Fn &&fn) {
+      for (int i = 1; i <= Frames; i++)
+        read(slots[(current + i) % Frames], true, fn);
+    }
+
+    bool begin(const char *name) {
+      Slot &slot = slots[current];
+      if (!supported || open || slot.count == ZonesPerFrame)
+        return false;
+      slot.names[slot.count] = name;
+      slot.submitNs[slot.count] = now();
+      glBeginQuery(GL_TIME_ELAPSED, slot.queries[slot.count]);
+      open = true;
+      return true;
+    }
+    void end() {
+      glEndQuery(GL_TIME_ELAPSED);
+      slots[current].count++;
+      open = false;
+    }
+    [[nodiscard]] uint64_t dropped() const {
+      return lost;
+    }
+
+    ~GpuProfiler() {
+      for (Slot &slot : slots)
+        glDeleteQueries(ZonesPerFrame, slot.queries.data());
+    }
+
+  private:
+    struct Slot {
+      std::array<GLuint, ZonesPerFrame> queries{};
+      std::array<const char *, ZonesPerFrame> names{};
+      std::array<int64_t, ZonesPerFrame> submitNs{};
+      int count = 0;
+    };
+
+    static int64_t now() {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    template<typename Fn>
+    void read(Slot &slot, bool wait, Fn &fn) {
+      if (!slot.count)
+        return;
+      // queries of a frame complete in order, the last one tells about all of them
+      GLint ready = GL_FALSE;
+      if (!wait)
+        glGetQueryObjectiv(slot.queries[slot.count - 1], GL_QUERY_RESULT_AVAILABLE, &ready);
+      if (!wait && !ready) {
+        lost += slot.count;
+        slot.count = 0;
+        return;
+      }
+      for (int i = 0; i < slot.count; i++) {
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(slot.queries[i], GL_QUERY_RESULT, &elapsed);
+        int64_t begin = std::max(slot.submitNs[i], gpuEndNs);
+        gpuEndNs = begin + static_cast<int64_t>(elapsed);
+        fn(Result{slot.names[i], begin, gpuEndNs});
+      }
+      slot.count = 0;
+    }
+
+    std::array<Slot, Frames> slots{};
+    int current = 0;
+    bool open = false;
+    bool supported = false;
+    int64_t gpuEndNs = 0;
+    uint64_t lost = 0;
+};
+
+// measures the GL commands of the enclosing scope
+template<typename Profiler>
+class GpuZone {
+  public:
+    GpuZone(Profiler *profiler, const char *name)
+        : profiler(profiler && profiler->begin(name) ? profiler : nullptr) {
+    }
+    GpuZone(const GpuZone &) = delete;
+    GpuZone &operator=(const GpuZone &) = delete;
+    ~GpuZone() {
+      if (profiler)
+        profiler->end();
+    }
+
+  private:
+    Profiler *profiler;
+};
+}
+
+#define OGL_GPU_ZONE_CONCAT_(a, b) a##b
+#define OGL_GPU_ZONE_CONCAT(a, b) OGL_GPU_ZONE_CONCAT_(a, b)
+// profiler may be null, then nothing is measured; compiled out with HCI_PROFILING=0
+#if HCI_PROFILING
+#define OGL_GPU_ZONE(profiler, name) \
+  ::opengl::GpuZone OGL_GPU_ZONE_CONCAT(oglGpuZone, __LINE__)((profiler), (name))
+#else
+#define OGL_GPU_ZONE(profiler, name) static_cast<void>(0)
+#endif
+
+#endif
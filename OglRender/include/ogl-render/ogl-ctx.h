@@ -3,7 +3,9 @@
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
+#include <ogl-render/gl-state.h>
 #include <ogl-render/shader-prog.h>
+#include <ogl-render/vertex-format.h>
 #include <memory>
 #include <vector>
 #include <unordered_map>
@@ -28,15 +30,15 @@ struct VertexBufferObj : NonCopyable {
     other.id = 0;
   }
   void bind() const {
-    glBindBuffer(GL_ARRAY_BUFFER, id);
+    glstate().bindArrayBuffer(id);
   }
   template<typename T>
-  void allocData(const std::vector<T> &data) {
-    glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(T), (void *) data.data(), GL_STATIC_DRAW);
+  void allocData(const std::vector<T> &data, GLenum usage = GL_STATIC_DRAW) {
+    glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(T), (void *) data.data(), usage);
   }
   template<typename T>
-  void allocData(const T *data, int size) {
-    glBufferData(GL_ARRAY_BUFFER, size * sizeof(T), (void *) data, GL_STATIC_DRAW);
+  void allocData(const T *data, int size, GLenum usage = GL_STATIC_DRAW) {
+    glBufferData(GL_ARRAY_BUFFER, size * sizeof(T), (void *) data, usage);
   }
   template<typename T>
   void passData(const std::vector<T> &data) {
@@ -46,48 +48,105 @@ struct VertexBufferObj : NonCopyable {
   void updateData(const T* data, int offset, int size) {
     glBufferSubData(GL_ARRAY_BUFFER, offset * sizeof(T), size * sizeof(T), data);
   }
-  void bind() {
-    glBindBuffer(GL_ARRAY_BUFFER, id);
-  }
   ~VertexBufferObj() {
+    if (!id)
+      return;
+    glstate().deletedBuffer(id);
     glDeleteBuffers(1, &id);
   }
 };
 
+// records of type T, one per instance, in a buffer of their own
+// the buffer is only reallocated when it has to grow, and any range of records can be rewritten in place
+template<typename T>
+struct InstanceBuffer : NonCopyable {
+  VertexBufferObj vbo;
+  int count = 0;
+  int capacity = 0;
+  InstanceBuffer() = default;
+  explicit InstanceBuffer(const std::vector<T> &data, GLenum usage = GL_DYNAMIC_DRAW) {
+    assign(data, usage);
+  }
+  void bind() {
+    vbo.bind();
+  }
+  void assign(const T *data, int size, GLenum usage = GL_DYNAMIC_DRAW) {
+    vbo.bind();
+    if (size > capacity) {
+      vbo.allocData(data, size, usage);
+      capacity = size;
+    } else if (size > 0)
+      vbo.updateData(data, 0, size);
+    count = size;
+  }
+  void assign(const std::vector<T> &data, GLenum usage = GL_DYNAMIC_DRAW) {
+    assign(data.data(), static_cast<int>(data.size()), usage);
+  }
+  // rewrites records [first, first + size)
+  void update(const T *data, int first, int size) {
+    vbo.bind();
+    vbo.updateData(data, first, size);
+  }
+  void update(const T &record, int index) {
+    update(&record, index, 1);
+  }
+};
+
 struct VertexArrayObj : NonCopyable {
   GLuint id;
   VertexArrayObj() {
     glGenVertexArrays(1, &id);
   }
   void bind() const {
-    glBindVertexArray(id);
+    glstate().bindVertexArray(id);
   }
   static void unbind() {
-    glBindVertexArray(0);
+    glstate().bindVertexArray(0);
   }
   ~VertexArrayObj() {
+    // GL unbinds it when it is bound
+    glstate().deletedVertexArray(id);
     glDeleteVertexArrays(1, &id);
-    glBindVertexArray(0);
   }
 };
 
 struct ElementBufferObj : NonCopyable {
   GLuint id;
+  // of the indices last passed
+  GLenum type = GL_UNSIGNED_INT;
+  int count = 0;
   ElementBufferObj() {
     glGenBuffers(1, &id);
   }
   ElementBufferObj(const std::vector<GLuint> &data) {
     glGenBuffers(1, &id);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, id);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, data.size() * sizeof(GLuint), data.data(), GL_STATIC_DRAW);
+    bind();
+    passData(data);
   }
   void passData(const std::vector<GLuint> &data) {
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, data.size() * sizeof(GLuint), data.data(), GL_STATIC_DRAW);
+    type = GL_UNSIGNED_INT;
+    count = static_cast<int>(data.size());
   }
-  void bind() {
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, id);
+  // 16-bit indices when all vertexCount vertices can be addressed with them, 32-bit otherwise
+  static GLenum indexType(size_t vertexCount) {
+    return vertexCount <= 65536 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+  }
+  void passIndices(const std::vector<GLuint> &data, size_t vertexCount) {
+    if (indexType(vertexCount) == GL_UNSIGNED_INT) {
+      passData(data);
+      return;
+    }
+    std::vector<GLushort> narrow(data.begin(), data.end());
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, narrow.size() * sizeof(GLushort), narrow.data(), GL_STATIC_DRAW);
+    type = GL_UNSIGNED_SHORT;
+    count = static_cast<int>(data.size());
+  }
+  void bind() const {
+    glstate().bindElementBuffer(id);
   }
   ~ElementBufferObj() {
+    glstate().deletedBuffer(id);
     glDeleteBuffers(1, &id);
   }
 };
@@ -101,14 +160,29 @@ struct OpenGLContext : NonCopyable {
   OpenGLContext() = default;
   std::unordered_map<std::string, GLuint> attributes;
 
+  // the attribute advances once per vertex with divisor 0, otherwise once every divisor instances
   void registerAttribute(const std::string &name,
                          GLsizei size,
                          GLenum type,
                          GLboolean normalized,
                          GLsizei stride,
-                         const void *pointer) {
+                         const void *pointer,
+                         GLuint divisor = 0) {
     attributes[name] = attribute_count++;
     glVertexAttribPointer(attributes[name], size, type, normalized, stride, pointer);
+    glVertexAttribDivisor(attributes[name], divisor);
+    glEnableVertexAttribArray(attributes[name]);
+  }
+  // an integer attribute, read by the shader as int/uint vectors without conversion to float
+  void registerIntegerAttribute(const std::string &name,
+                                GLsizei size,
+                                GLenum type,
+                                GLsizei stride,
+                                const void *pointer,
+                                GLuint divisor = 0) {
+    attributes[name] = attribute_count++;
+    glVertexAttribIPointer(attributes[name], size, type, stride, pointer);
+    glVertexAttribDivisor(attributes[name], divisor);
     glEnableVertexAttribArray(attributes[name]);
   }
   int attribute(const std::string &name) {
@@ -127,6 +201,58 @@ struct OpenGLContext : NonCopyable {
     registerAttribute(name, size, type, false, stride, 0);
   }
 
+  // one buffer of interleaved vertices of type V, with an attribute per field of V::Layout
+  // (ogl-render/vertex-format.h) named by names, in order
+  template<typename V>
+  void newVertices(const std::vector<V> &data, std::initializer_list<std::string> names,
+                   GLenum usage = GL_STATIC_DRAW) {
+    using Layout = typename V::Layout;
+    static_assert(Layout::template describes<V>(), "V::Layout does not match the fields of V");
+    if (names.size() != Layout::count) {
+      std::cerr << "[Warning] " << names.size() << " names for " << Layout::count << " vertex fields" << std::endl;
+      return;
+    }
+    vbo.emplace_back();
+    vbo.back().bind();
+    vbo.back().allocData(data, usage);
+    auto name = names.begin();
+    for (const auto &field : Layout::attributes) {
+      if (field.integer)
+        registerIntegerAttribute(*name++, field.size, field.type, Layout::stride, (const void *) field.offset);
+      else
+        registerAttribute(*name++, field.size, field.type, field.normalized, Layout::stride,
+                          (const void *) field.offset);
+    }
+  }
+
+  // a field of the records in buffer, at byte offset in T, e.g. offsetof(TileInstance, position)
+  template<typename T>
+  void instanceAttribute(const std::string &name, InstanceBuffer<T> &buffer, int size, int type, size_t offset,
+                         GLuint divisor = 1, bool normalized = false) {
+    buffer.bind();
+    registerAttribute(name, size, type, normalized, sizeof(T), (const void *) offset, divisor);
+  }
+  template<typename T>
+  void instanceIntegerAttribute(const std::string &name, InstanceBuffer<T> &buffer, int size, int type,
+                                size_t offset, GLuint divisor = 1) {
+    buffer.bind();
+    registerIntegerAttribute(name, size, type, sizeof(T), (const void *) offset, divisor);
+  }
+
+  // a field of the records of a StreamBuffer (ogl-render/stream-buffer.h), pointed at each frame's records there
+  template<typename Stream>
+  void streamAttribute(const std::string &name, Stream &stream, int size, int type, size_t offset,
+                       GLuint divisor = 0, bool normalized = false) {
+    attributes[name] = attribute_count++;
+    stream.attribute(attributes[name], size, type, offset, divisor, normalized);
+  }
+  template<typename Stream>
+  void streamIntegerAttribute(const std::string &name, Stream &stream, int size, int type, size_t offset,
+                              GLuint divisor = 0) {
+    attributes[name] = attribute_count++;
+    stream.integerAttribute(attributes[name], size, type, offset, divisor);
+  }
+
   template<typename T>
   void designateAttributeData(const std::string &name, const std::vector<T> &data, int size, int stride, int type) {
     if (attributes.find(name) == attributes.end()) {
@@ -137,8 +263,23 @@ struct OpenGLContext : NonCopyable {
     glEnableVertexAttribArray(attributes[name]);
   }
 
-  static void draw(GLuint mode, int count) {
-    glDrawElements(mode, count, GL_UNSIGNED_INT, 0);
+  // the first count indices of ebo, of whatever type they were passed as
+  void draw(GLuint mode, int count) const {
+    glDrawElements(mode, count, ebo.type, 0);
+  }
+  // all indices of ebo, of whatever type they were passed as
+  void drawIndexed(GLuint mode) const {
+    glDrawElements(mode, ebo.count, ebo.type, 0);
+  }
+  static void drawArrays(GLuint mode, int first, int count) {
+    glDrawArrays(mode, first, count);
+  }
+  // the first count indices of ebo drawn once per instance, with instance attributes advancing by their divisor
+  void drawInstanced(GLuint mode, int count, int instances) const {
+    glDrawElementsInstanced(mode, count, ebo.type, 0, instances);
+  }
+  static void drawArraysInstanced(GLuint mode, int first, int count, int instances) {
+    glDrawArraysInstanced(mode, first, count, instances);
   }
 
   static void unbind() {
@@ -0,0 +1,65 @@
+#ifndef OGL_RENDER_INCLUDE_OGL_RENDER_PROGRAM_CACHE_H_
+#define OGL_RENDER_INCLUDE_OGL_RENDER_PROGRAM_CACHE_H_
+
+#include <glad/glad.h>
+#include <ogl-render/shader-prog.h>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace opengl {
+// the shader files of a program; gs_path may stay empty
+struct ProgramSource {
+  std::string vs_path, fs_path, gs_path;
+};
+
+// builds programs from the binaries an earlier run saved (glGetProgramBinary), keyed by a hash of the source
+// text and of the GL vendor, renderer and version. Whenever there is no usable binary (none saved, rejected by
+// the driver, or no binary formats at all) the program is compiled from source and its binary saved for next
+// time. Programs passed to prefetch() are compiled and linked together, on driver threads where
+// KHR_parallel_shader_compile is loaded (gl-ext.h), and only waited for when load() asks for them.
+class ProgramCache {
+  public:
+    struct Stats {
+      // linked from a saved binary, compiled from source, saved binaries the driver did not take
+      int hits = 0, misses = 0, rejected = 0;
+    };
+
+    // needs a current context with glext loaded; an empty dir saves nothing
+    explicit ProgramCache(std::string dir);
+    ProgramCache(const ProgramCache&) = delete;
+    ProgramCache& operator=(const ProgramCache&) = delete;
+    ~ProgramCache();
+
+    void prefetch(std::initializer_list<ProgramSource> sources);
+    // null when the program does not compile or link, after printing why
+    std::unique_ptr<ShaderProg> load(const ProgramSource& source);
+    [[nodiscard]] const Stats& stats() const {
+      return counters;
+    }
+
+  private:
+    struct Build {
+      ProgramSource source;
+      uint64_t key = 0;
+      GLuint program = 0;
+      std::vector<std::pair<GLuint, const char *>> shaders;
+      bool fromBinary = false;
+    };
+
+    Build start(const ProgramSource& source);
+    bool finish(Build& build);
+    [[nodiscard]] std::string binaryPath(uint64_t key) const;
+    bool loadBinary(Build& build);
+    void saveBinary(const Build& build);
+
+    std::string dir;
+    std::string driver;
+    Stats counters;
+    std::vector<Build> pending;
+};
+}
+
+#endif
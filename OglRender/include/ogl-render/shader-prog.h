@@ -2,6 +2,7 @@
 #define OGL_RENDER_INCLUDE_OGL_RENDER_SHADER_PROG_H_
 
 #include <glad/glad.h>
+#include <ogl-render/gl-state.h>
 
 #include <fstream>
 #include <ios>
@@ -86,6 +87,28 @@ struct ShaderProg {
     glGetProgramiv(id, GL_ACTIVE_UNIFORMS, &uniform_count);
     glGetProgramiv(id, GL_ACTIVE_ATTRIBUTES, &attribute_count);
   }
+  // a uniform resolved once after linking, so setting it needs no lookup by name; -1 (ignored by GL) when the
+  // program has no such active uniform
+  struct Uniform {
+    GLint location = -1;
+  };
+  Uniform uniform(const std::string &name) const {
+    return {glGetUniformLocation(id, name.c_str())};
+  }
+  // attaches the uniform block name to binding, where a UniformBlock (ogl-render/uniform-block.h) is
+  bool bindBlock(const std::string &name, GLuint binding) const {
+    GLuint index = glGetUniformBlockIndex(id, name.c_str());
+    if (index == GL_INVALID_INDEX)
+      return false;
+    glUniformBlockBinding(id, index, binding);
+    return true;
+  }
+
+  // takes over a linked program, e.g. one ProgramCache (ogl-render/program-cache.h) built
+  explicit ShaderProg(GLuint program) : id(program) {
+    glGetProgramiv(id, GL_ACTIVE_UNIFORMS, &uniform_count);
+    glGetProgramiv(id, GL_ACTIVE_ATTRIBUTES, &attribute_count);
+  }
   std::unordered_map<std::string, GLuint> uniform_handles;
   std::unordered_map<std::string, GLuint> attribute_handles;
   void initUniformHandles();
@@ -104,50 +127,81 @@ struct ShaderProg {
     }
   }
 
-  void use() const { glUseProgram(id); }
+  void use() const { glstate().useProgram(id); }
   static void unuse() {
-    glUseProgram(0);
+    glstate().useProgram(0);
+  }
+  // by name, from uniform_handles (see initUniformHandles); unknown names are ignored
+  GLint location(const std::string &name) const {
+    auto it = uniform_handles.find(name);
+    return it == uniform_handles.end() ? -1 : static_cast<GLint>(it->second);
   }
   void setInt(const std::string &name, int value) {
-    glUniform1i(uniform_handles[name], value);
+    glUniform1i(location(name), value);
   }
   void setFloat(const std::string &name, float value) {
-    glUniform1f(uniform_handles[name], value);
+    glUniform1f(location(name), value);
   }
   void setVec2f(const std::string &name, float x, float y) {
-    glUniform2f(uniform_handles[name], x, y);
+    glUniform2f(location(name), x, y);
   }
   void setVec2f(const std::string &name, const glm::vec2 &value) {
-    glUniform2f(uniform_handles[name], value.x, value.y);
+    glUniform2f(location(name), value.x, value.y);
   }
   void setVec3f(const std::string &name, float x, float y, float z) {
-    glUniform3f(uniform_handles[name], x, y, z);
+    glUniform3f(location(name), x, y, z);
   }
   void setVec3f(const std::string &name, const glm::vec3 &value) {
-    glUniform3f(uniform_handles[name], value.x, value.y, value.z);
+    glUniform3f(location(name), value.x, value.y, value.z);
   }
   void setVec4f(const std::string &name, float x, float y, float z, float w) {
-    glUniform4f(uniform_handles[name], x, y, z, w);
+    glUniform4f(location(name), x, y, z, w);
   }
   void setVec4f(const std::string &name, const glm::vec4 &value) {
-    glUniform4f(uniform_handles[name], value.x, value.y, value.z, value.w);
+    glUniform4f(location(name), value.x, value.y, value.z, value.w);
   }
   void setMat2f(const std::string &name, const glm::mat2 &mat) {
-    glUniformMatrix2fv(uniform_handles[name], 1, GL_FALSE, &mat[0][0]);
+    glUniformMatrix2fv(location(name), 1, GL_FALSE, &mat[0][0]);
   }
   void setMat3f(const std::string &name, const glm::mat3 &mat) {
-    glUniformMatrix3fv(uniform_handles[name], 1, GL_FALSE, &mat[0][0]);
+    glUniformMatrix3fv(location(name), 1, GL_FALSE, &mat[0][0]);
   }
   void setMat4f(const std::string &name, const glm::mat4 &mat) {
-    glUniformMatrix4fv(uniform_handles[name], 1, GL_FALSE, &mat[0][0]);
+    glUniformMatrix4fv(location(name), 1, GL_FALSE, &mat[0][0]);
   }
 
+  // by pre-resolved handle, for the render loop; like the setters by name, on the program in use
+  static void setInt(Uniform uniform, int value) {
+    glUniform1i(uniform.location, value);
+  }
+  static void setFloat(Uniform uniform, float value) {
+    glUniform1f(uniform.location, value);
+  }
+  static void setVec2f(Uniform uniform, const glm::vec2 &value) {
+    glUniform2f(uniform.location, value.x, value.y);
+  }
+  static void setVec3f(Uniform uniform, const glm::vec3 &value) {
+    glUniform3f(uniform.location, value.x, value.y, value.z);
+  }
+  static void setVec4f(Uniform uniform, const glm::vec4 &value) {
+    glUniform4f(uniform.location, value.x, value.y, value.z, value.w);
+  }
+  static void setMat2f(Uniform uniform, const glm::mat2 &mat) {
+    glUniformMatrix2fv(uniform.location, 1, GL_FALSE, &mat[0][0]);
+  }
+  static void setMat3f(Uniform uniform, const glm::mat3 &mat) {
+    glUniformMatrix3fv(uniform.location, 1, GL_FALSE, &mat[0][0]);
+  }
+  static void setMat4f(Uniform uniform, const glm::mat4 &mat) {
+    glUniformMatrix4fv(uniform.location, 1, GL_FALSE, &mat[0][0]);
+  }
 
-  ~ShaderProg() { glDeleteProgram(id); }
- private:
-  int uniform_count;
-  int attribute_count;
-  static void checkCompileErrors(GLuint shader, std::string type) {
+  ~ShaderProg() {
+    glstate().deletedProgram(id);
+    glDeleteProgram(id);
+  }
+  // prints the log of a shader of type "VERTEX", "FRAGMENT" or "GEOMETRY", or of a "PROGRAM", when it failed
+  static bool checkCompileErrors(GLuint shader, std::string type) {
     GLint success;
     GLchar infoLog[1024];
     if (type != "PROGRAM") {
@@ -165,7 +219,12 @@ struct ShaderProg {
                   << "\n -- --------------------------------------------------- -- " << std::endl;
       }
     }
+    return success;
   }
+
+ private:
+  int uniform_count;
+  int attribute_count;
 };
 }  // namespace core
 
@@ -0,0 +1,131 @@
+#ifndef OGL_RENDER_INCLUDE_OGL_RENDER_STREAM_BUFFER_H_
+#define OGL_RENDER_INCLUDE_OGL_RENDER_STREAM_BUFFER_H_
+
+#include <glad/glad.h>
+#include <ogl-render/gl-ext.h>
+#include <ogl-render/ogl-ctx.h>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace opengl {
+// a vertex buffer of records of type T written anew every frame, straight into mapped memory
+// with glBufferStorage the buffer holds Regions copies of a frame, mapped once (persistently and coherently):
+// each frame writes the region after the last one and fences it after its draws, so by the time a region
+// comes round again the GPU is long done with it and the CPU never waits. Without it (GL 3.3) every frame
+// orphans the buffer and maps the fresh storage, leaving the driver to keep the old one alive while it is read.
+// usage per frame, with the vertex array bound: T *p = begin(); ...write...; end(count); draw; fence();
+template<typename T, int Regions = 3>
+struct StreamBuffer : NonCopyable {
+  struct Stats {
+    uint64_t frames = 0;
+    // frames whose region was still in use by the GPU
+    uint64_t waits = 0;
+  };
+
+  VertexBufferObj vbo;
+  Stats stats;
+
+  // capacity records per frame
+  explicit StreamBuffer(int capacity) : capacity(capacity) {
+    // regions start on their own cache lines
+    region_bytes = (capacity * sizeof(T) + 255) & ~size_t{255};
+    vbo.bind();
+    if (glext.bufferStorage) {
+      GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+      glext.bufferStorage(GL_ARRAY_BUFFER, region_bytes * Regions, nullptr, flags);
+      mapping = static_cast<char *>(glMapBufferRange(GL_ARRAY_BUFFER, 0, region_bytes * Regions, flags));
+    } else
+      glBufferData(GL_ARRAY_BUFFER, region_bytes, nullptr, GL_STREAM_DRAW);
+  }
+  [[nodiscard]] bool persistent() const {
+    return mapping != nullptr;
+  }
+
+  // the attribute at location reads field offset of the records; re-pointed to the frame's region in end()
+  void attribute(GLuint location, int size, GLenum type, size_t offset, GLuint divisor = 0,
+                 bool normalized = false) {
+    attributes.push_back({location, size, type, offset, divisor, normalized, false});
+  }
+  void integerAttribute(GLuint location, int size, GLenum type, size_t offset, GLuint divisor = 0) {
+    attributes.push_back({location, size, type, offset, divisor, false, true});
+  }
+
+  // room for capacity records of this frame
+  T *begin() {
+    stats.frames++;
+    vbo.bind();
+    if (!mapping) {
+      glBufferData(GL_ARRAY_BUFFER, region_bytes, nullptr, GL_STREAM_DRAW);
+      return static_cast<T *>(glMapBufferRange(GL_ARRAY_BUFFER, 0, region_bytes,
+                                               GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+    }
+    region = (region + 1) % Regions;
+    if (GLsync fence = fences[region]) {
+      // only when the GPU is Regions frames behind
+      if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+        stats.waits++;
+        while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000'000) == GL_TIMEOUT_EXPIRED);
+      }
+      glDeleteSync(fence);
+      fences[region] = nullptr;
+    }
+    return reinterpret_cast<T *>(mapping + region * region_bytes);
+  }
+  // count records were written; points the attributes at them, the vertex array they belong to must be bound
+  void end(int count) {
+    written = count;
+    vbo.bind();
+    if (!mapping)
+      glUnmapBuffer(GL_ARRAY_BUFFER);
+    size_t base = mapping ? region * region_bytes : 0;
+    for (const auto &a : attributes) {
+      const void *pointer = reinterpret_cast<const void *>(base + a.offset);
+      if (a.integer)
+        glVertexAttribIPointer(a.location, a.size, a.type, sizeof(T), pointer);
+      else
+        glVertexAttribPointer(a.location, a.size, a.type, a.normalized, sizeof(T), pointer);
+      glVertexAttribDivisor(a.location, a.divisor);
+      glEnableVertexAttribArray(a.location);
+    }
+  }
+  // after the last draw reading this frame's records
+  void fence() {
+    if (mapping)
+      fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  }
+  [[nodiscard]] int count() const {
+    return written;
+  }
+
+  ~StreamBuffer() {
+    for (GLsync fence : fences)
+      if (fence)
+        glDeleteSync(fence);
+    if (mapping) {
+      vbo.bind();
+      glUnmapBuffer(GL_ARRAY_BUFFER);
+    }
+  }
+
+ private:
+  struct Attribute {
+    GLuint location;
+    int size;
+    GLenum type;
+    size_t offset;
+    GLuint divisor;
+    bool normalized;
+    bool integer;
+  };
+  int capacity;
+  int written = 0;
+  size_t region_bytes;
+  int region = 0;
+  char *mapping = nullptr;
+  std::array<GLsync, Regions> fences{};
+  std::vector<Attribute> attributes;
+};
+}
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef OGL_RENDER_INCLUDE_OGL_RENDER_TEXTURE_H_
+#define OGL_RENDER_INCLUDE_OGL_RENDER_TEXTURE_H_
+
+#include <glad/glad.h>
+#include <ogl-render/ogl-ctx.h>
+
+namespace opengl {
+// RAII 2D texture of a single level, sampled without filtering by default
+// integer formats (GL_R8UI and the like) take GL_RED_INTEGER data and are read with texelFetch
+struct Texture2D : NonCopyable {
+  GLuint id{};
+  int width = 0;
+  int height = 0;
+  GLenum format;
+  GLenum type;
+  Texture2D(int width, int height, GLenum internal_format, GLenum format, GLenum type, const void *data = nullptr,
+            GLenum filter = GL_NEAREST)
+      : width(width), height(height), format(format), type(type) {
+    glGenTextures(1, &id);
+    glstate().bindTexture2D(id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    // rows of byte texels are not padded to 4 bytes
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, internal_format, width, height, 0, format, type, data);
+  }
+  void bind(int unit = 0) const {
+    glstate().bindTexture2D(id, unit);
+  }
+  // rewrites the w x h texels at (x, y), a single one for a changed tile
+  void update(int x, int y, int w, int h, const void *data) {
+    glstate().bindTexture2D(id);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, w, h, format, type, data);
+  }
+  static int maxSize() {
+    GLint size = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &size);
+    return size;
+  }
+  ~Texture2D() {
+    glstate().deletedTexture(id);
+    glDeleteTextures(1, &id);
+  }
+};
+}
+
+#endif
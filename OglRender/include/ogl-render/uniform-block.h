@@ -0,0 +1,50 @@
+#ifndef OGL_RENDER_INCLUDE_OGL_RENDER_UNIFORM_BLOCK_H_
+#define OGL_RENDER_INCLUDE_OGL_RENDER_UNIFORM_BLOCK_H_
+
+#include <glad/glad.h>
+#include <ogl-render/gl-state.h>
+#include <ogl-render/ogl-ctx.h>
+#include <cstdint>
+#include <cstring>
+
+namespace opengl {
+// a struct T in a uniform buffer at binding point binding, read by every program that attached a block of the
+// same layout there (ShaderProg::bindBlock). T must be laid out as the std140 block is, e.g. with vec4 and mat4
+// members, or padded to 16 bytes where std140 pads.
+template<typename T>
+struct UniformBlock : NonCopyable {
+  GLuint id{};
+  GLuint binding;
+  // uploads that changed something
+  uint64_t uploads = 0;
+
+  explicit UniformBlock(GLuint binding, const T &initial = T{}) : binding(binding), data(initial) {
+    glGenBuffers(1, &id);
+    glstate().bindUniformBuffer(id);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(T), &data, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, binding, id);
+  }
+  // once per frame for all the programs reading it, and not at all while value stays the same
+  bool update(const T &value) {
+    if (!std::memcmp(&value, &data, sizeof(T)))
+      return false;
+    data = value;
+    glstate().bindUniformBuffer(id);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(T), &data);
+    uploads++;
+    return true;
+  }
+  [[nodiscard]] const T &value() const {
+    return data;
+  }
+  ~UniformBlock() {
+    glstate().deletedBuffer(id);
+    glDeleteBuffers(1, &id);
+  }
+
+ private:
+  T data;
+};
+}
+
+#endif
@@ -0,0 +1,143 @@
+#ifndef OGL_RENDER_INCLUDE_OGL_RENDER_VERTEX_FORMAT_H_
+#define OGL_RENDER_INCLUDE_OGL_RENDER_VERTEX_FORMAT_H_
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace opengl {
+// IEEE 754 binary16, widened to float by GL; 11 significant bits, so for normals, texture coordinates and
+// small ranges rather than large coordinates
+struct Half {
+  uint16_t bits = 0;
+  Half() = default;
+  Half(float value) : bits(fromFloat(value)) {}
+
+  // rounds to nearest even; overflow goes to infinity, values below the smallest subnormal to zero
+  static uint16_t fromFloat(float value) {
+    uint32_t f;
+    std::memcpy(&f, &value, sizeof(f));
+    auto sign = static_cast<uint16_t>((f >> 16) & 0x8000);
+    uint32_t abs = f & 0x7fffffff;
+    if (abs >= 0x7f800000)
+      return sign | 0x7c00 | (abs > 0x7f800000 ? 0x200 : 0);
+    if (abs >= 0x477ff000)
+      return sign | 0x7c00;
+    if (abs < 0x38800000) {
+      // subnormal half: shift the mantissa with its implicit bit into place
+      if (abs < 0x33000000)
+        return sign;
+      uint32_t exponent = abs >> 23, mantissa = (abs & 0x7fffff) | 0x800000;
+      uint32_t shift = 126 - exponent;
+      uint32_t half = mantissa >> shift, rest = mantissa & ((1u << shift) - 1), middle = 1u << (shift - 1);
+      if (rest > middle || (rest == middle && (half & 1)))
+        half++;
+      return sign | static_cast<uint16_t>(half);
+    }
+    uint32_t half = ((abs - 0x38000000) >> 13), rest = abs & 0x1fff;
+    if (rest > 0x1000 || (rest == 0x1000 && (half & 1)))
+      half++;
+    return sign | static_cast<uint16_t>(half);
+  }
+};
+struct Half2 {
+  Half x, y;
+};
+struct Half4 {
+  Half x, y, z, w;
+};
+
+// RGBA8 read as floats in [0, 1]
+struct Unorm8x4 {
+  uint8_t r = 0, g = 0, b = 0, a = 255;
+  static Unorm8x4 fromColor(const glm::vec3 &color, float alpha = 1.0f) {
+    auto unorm = [](float c) { return static_cast<uint8_t>(glm::clamp(c, 0.0f, 1.0f) * 255.0f + 0.5f); };
+    return {unorm(color.r), unorm(color.g), unorm(color.b), unorm(alpha)};
+  }
+};
+
+// int16 converted to float as it is, e.g. whole tile coordinates
+struct Short2 {
+  int16_t x, y;
+};
+struct Short4 {
+  int16_t x, y, z, w;
+};
+
+// how GL reads a vertex field of type T
+template<GLint Size, GLenum Type, bool Normalized = false, bool Integer = false>
+struct AttributeFormat {
+  static constexpr GLint size = Size;
+  static constexpr GLenum type = Type;
+  static constexpr bool normalized = Normalized;
+  // read by the shader as int/uint vectors without conversion to float
+  static constexpr bool integer = Integer;
+};
+template<typename T>
+struct AttributeTraits;
+template<> struct AttributeTraits<float> : AttributeFormat<1, GL_FLOAT> {};
+template<> struct AttributeTraits<glm::vec2> : AttributeFormat<2, GL_FLOAT> {};
+template<> struct AttributeTraits<glm::vec3> : AttributeFormat<3, GL_FLOAT> {};
+template<> struct AttributeTraits<glm::vec4> : AttributeFormat<4, GL_FLOAT> {};
+template<> struct AttributeTraits<uint32_t> : AttributeFormat<1, GL_UNSIGNED_INT, false, true> {};
+template<> struct AttributeTraits<Half2> : AttributeFormat<2, GL_HALF_FLOAT> {};
+template<> struct AttributeTraits<Half4> : AttributeFormat<4, GL_HALF_FLOAT> {};
+template<> struct AttributeTraits<Unorm8x4> : AttributeFormat<4, GL_UNSIGNED_BYTE, true> {};
+template<> struct AttributeTraits<Short2> : AttributeFormat<2, GL_SHORT> {};
+template<> struct AttributeTraits<Short4> : AttributeFormat<4, GL_SHORT> {};
+
+// the interleaved layout of a vertex struct whose fields have types Fields..., in order, laid out the way the
+// compiler lays out the struct. A vertex type names its layout:
+//   struct V { Short4 position; Unorm8x4 color; using Layout = VertexLayout<Short4, Unorm8x4>; };
+// and OpenGLContext::newVertices checks it against the struct and registers one attribute per field.
+template<typename... Fields>
+struct VertexLayout {
+  static_assert(sizeof...(Fields) > 0, "a vertex needs at least one field");
+
+  struct Attribute {
+    GLint size;
+    GLenum type;
+    bool normalized;
+    bool integer;
+    size_t offset;
+  };
+
+  static constexpr int count = sizeof...(Fields);
+  static constexpr size_t align = std::max({alignof(Fields)...});
+  static constexpr std::array<size_t, count> offsets = [] {
+    std::array<size_t, count> result{};
+    std::array<size_t, count> sizes{sizeof(Fields)...}, aligns{alignof(Fields)...};
+    size_t at = 0;
+    for (int i = 0; i < count; i++) {
+      at = (at + aligns[i] - 1) / aligns[i] * aligns[i];
+      result[i] = at;
+      at += sizes[i];
+    }
+    return result;
+  }();
+  static constexpr size_t stride = [] {
+    std::array<size_t, count> sizes{sizeof(Fields)...};
+    return (offsets[count - 1] + sizes[count - 1] + align - 1) / align * align;
+  }();
+  static constexpr std::array<Attribute, count> attributes = [] {
+    std::array<Attribute, count> result{
+        Attribute{AttributeTraits<Fields>::size, AttributeTraits<Fields>::type, AttributeTraits<Fields>::normalized,
+                  AttributeTraits<Fields>::integer, 0}...};
+    for (int i = 0; i < count; i++)
+      result[i].offset = offsets[i];
+    return result;
+  }();
+
+  // V is laid out as described; fields in a different order or of other types mostly change its size
+  template<typename V>
+  static constexpr bool describes() {
+    return sizeof(V) == stride && alignof(V) == align;
+  }
+};
+}
+
+#endif
@@ -0,0 +1,41 @@
+#include <ogl-render/gl-ext.h>
+#include <cstring>
+
+namespace opengl {
+GLExtensions glext;
+
+bool hasExtension(const char *name) {
+  GLint count = 0;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+  for (GLint i = 0; i < count; i++) {
+    auto extension = reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, i));
+    if (extension && !strcmp(extension, name))
+      return true;
+  }
+  return false;
+}
+
+bool hasVersion(int major, int minor) {
+  return GLVersion.major > major || (GLVersion.major == major && GLVersion.minor >= minor);
+}
+
+void loadExtensions(GLADloadproc load) {
+  glext = {};
+  if (hasVersion(4, 4) || hasExtension("GL_ARB_buffer_storage"))
+    glext.bufferStorage = reinterpret_cast<PFNGLBUFFERSTORAGEPROC>(load("glBufferStorage"));
+  GLint binaryFormats = 0;
+  if (hasVersion(4, 1) || hasExtension("GL_ARB_get_program_binary"))
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binaryFormats);
+  if (binaryFormats > 0) {
+    glext.getProgramBinary = reinterpret_cast<PFNGLGETPROGRAMBINARYPROC>(load("glGetProgramBinary"));
+    glext.programBinary = reinterpret_cast<PFNGLPROGRAMBINARYPROC>(load("glProgramBinary"));
+    glext.programParameteri = reinterpret_cast<PFNGLPROGRAMPARAMETERIPROC>(load("glProgramParameteri"));
+  }
+  if (hasExtension("GL_KHR_parallel_shader_compile"))
+    glext.maxShaderCompilerThreads =
+        reinterpret_cast<PFNGLMAXSHADERCOMPILERTHREADSKHRPROC>(load("glMaxShaderCompilerThreadsKHR"));
+  else if (hasExtension("GL_ARB_parallel_shader_compile"))
+    glext.maxShaderCompilerThreads =
+        reinterpret_cast<PFNGLMAXSHADERCOMPILERTHREADSKHRPROC>(load("glMaxShaderCompilerThreadsARB"));
+}
+}
@@ -0,0 +1,20 @@
+#include <ogl-render/gl-state.h>
+
+namespace opengl {
+// GL makes contexts current per thread, and so are their caches
+static thread_local GLState *current = nullptr;
+
+GLState::~GLState() {
+  if (current == this)
+    current = nullptr;
+}
+
+void GLState::makeCurrent() {
+  current = this;
+}
+
+GLState &glstate() {
+  thread_local GLState fallback;
+  return current ? *current : fallback;
+}
+}
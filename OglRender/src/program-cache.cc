@@ -0,0 +1,222 @@
+#include <ogl-render/program-cache.h>
+#include <ogl-render/gl-ext.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace opengl {
+static constexpr char kBinaryMagic[4] = {'H', 'C', 'P', 'B'};
+static constexpr uint32_t kBinaryVersion = 1;
+
+// before the driver's bytes in a saved binary
+struct BinaryHeader {
+  char magic[4];
+  uint32_t version;
+  uint64_t key;
+  uint32_t format;
+  uint32_t length;
+};
+
+// FNV-1a; stable across runs and builds, which std::hash is not required to be
+static uint64_t hashText(uint64_t hash, const std::string &text) {
+  for (unsigned char c : text) {
+    hash ^= c;
+    hash *= 0x100000001b3ull;
+  }
+  // separates the texts hashed one after another
+  hash ^= 0xff;
+  return hash * 0x100000001b3ull;
+}
+
+static bool readText(const std::string &path, std::string &text) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ: " << path << std::endl;
+    return false;
+  }
+  std::stringstream stream;
+  stream << file.rdbuf();
+  text = stream.str();
+  return true;
+}
+
+static const char *glString(GLenum name) {
+  auto text = reinterpret_cast<const char *>(glGetString(name));
+  return text ? text : "";
+}
+
+ProgramCache::ProgramCache(std::string cacheDir) : dir(std::move(cacheDir)) {
+  driver = std::string(glString(GL_VENDOR)) + '\n' + glString(GL_RENDERER) + '\n' + glString(GL_VERSION);
+  if (glext.maxShaderCompilerThreads)
+    glext.maxShaderCompilerThreads(0xffffffff);
+  // without binary formats there is nothing to save
+  if (!glext.getProgramBinary)
+    dir.clear();
+  if (dir.empty())
+    return;
+  std::error_code error;
+  std::filesystem::create_directories(dir, error);
+  if (error) {
+    std::cerr << "[Warning] Shader cache " << dir << " unusable: " << error.message() << std::endl;
+    dir.clear();
+  }
+}
+
+ProgramCache::~ProgramCache() {
+  for (Build &build : pending) {
+    for (auto [shader, type] : build.shaders)
+      glDeleteShader(shader);
+    glDeleteProgram(build.program);
+  }
+}
+
+void ProgramCache::prefetch(std::initializer_list<ProgramSource> sources) {
+  for (const ProgramSource &source : sources)
+    pending.push_back(start(source));
+}
+
+std::unique_ptr<ShaderProg> ProgramCache::load(const ProgramSource &source) {
+  Build build;
+  auto it = std::find_if(pending.begin(), pending.end(), [&](const Build &b) {
+    return b.source.vs_path == source.vs_path && b.source.fs_path == source.fs_path &&
+           b.source.gs_path == source.gs_path;
+  });
+  if (it != pending.end()) {
+    build = std::move(*it);
+    pending.erase(it);
+  } else
+    build = start(source);
+  if (!finish(build))
+    return nullptr;
+  return std::make_unique<ShaderProg>(build.program);
+}
+
+std::string ProgramCache::binaryPath(uint64_t key) const {
+  char name[32];
+  std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+  return dir + "/" + name;
+}
+
+ProgramCache::Build ProgramCache::start(const ProgramSource &source) {
+  Build build;
+  build.source = source;
+  std::string vertexCode, fragmentCode, geometryCode;
+  if (!readText(source.vs_path, vertexCode) || !readText(source.fs_path, fragmentCode) ||
+      (!source.gs_path.empty() && !readText(source.gs_path, geometryCode)))
+    return build;
+  build.key = hashText(hashText(hashText(hashText(0xcbf29ce484222325ull, driver), vertexCode), fragmentCode),
+                       geometryCode);
+  if (loadBinary(build))
+    return build;
+
+  counters.misses++;
+  build.program = glCreateProgram();
+  auto compile = [&](GLenum type, const char *name, const std::string &code) {
+    GLuint shader = glCreateShader(type);
+    const char *text = code.c_str();
+    glShaderSource(shader, 1, &text, nullptr);
+    glCompileShader(shader);
+    glAttachShader(build.program, shader);
+    build.shaders.emplace_back(shader, name);
+  };
+  compile(GL_VERTEX_SHADER, "VERTEX", vertexCode);
+  compile(GL_FRAGMENT_SHADER, "FRAGMENT", fragmentCode);
+  if (!source.gs_path.empty())
+    compile(GL_GEOMETRY_SHADER, "GEOMETRY", geometryCode);
+  if (!dir.empty())
+    glext.programParameteri(build.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+  // no status is queried here, so with parallel compilation none of this has waited for the driver yet
+  glLinkProgram(build.program);
+  return build;
+}
+
+bool ProgramCache::finish(Build &build) {
+  if (!build.program)
+    return false;
+  if (build.fromBinary)
+    return true;
+  bool compiled = true;
+  for (auto [shader, type] : build.shaders) {
+    compiled = ShaderProg::checkCompileErrors(shader, type) && compiled;
+    glDeleteShader(shader);
+  }
+  build.shaders.clear();
+  if (!compiled || !ShaderProg::checkCompileErrors(build.program, "PROGRAM")) {
+    glDeleteProgram(build.program);
+    build.program = 0;
+    return false;
+  }
+  saveBinary(build);
+  return true;
+}
+
+bool ProgramCache::loadBinary(Build &build) {
+  if (dir.empty())
+    return false;
+  std::string path = binaryPath(build.key);
+  std::ifstream file(path, std::ios::binary);
+  BinaryHeader header{};
+  if (!file || !file.read(reinterpret_cast<char *>(&header), sizeof(header)))
+    return false;
+  if (std::memcmp(header.magic, kBinaryMagic, sizeof(kBinaryMagic)) != 0 || header.version != kBinaryVersion ||
+      header.key != build.key)
+    return false;
+  // a damaged or truncated file is compiled again, rather than trusted with the size of an allocation
+  std::error_code error;
+  uintmax_t size = std::filesystem::file_size(path, error);
+  if (error || !header.length || header.length != size - sizeof(header))
+    return false;
+  std::vector<char> binary(header.length);
+  if (!file.read(binary.data(), header.length))
+    return false;
+  GLuint program = glCreateProgram();
+  glext.programBinary(program, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
+  GLint linked = GL_FALSE;
+  glGetProgramiv(program, GL_LINK_STATUS, &linked);
+  if (!linked) {
+    // e.g. after a driver update that kept its version string; compiled again and overwritten
+    counters.rejected++;
+    glDeleteProgram(program);
+    return false;
+  }
+  counters.hits++;
+  build.program = program;
+  build.fromBinary = true;
+  return true;
+}
+
+void ProgramCache::saveBinary(const Build &build) {
+  if (dir.empty())
+    return;
+  GLint length = 0;
+  glGetProgramiv(build.program, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0)
+    return;
+  std::vector<char> binary(length);
+  GLenum format = 0;
+  glext.getProgramBinary(build.program, length, &length, &format, binary.data());
+  BinaryHeader header{};
+  std::memcpy(header.magic, kBinaryMagic, sizeof(kBinaryMagic));
+  header.version = kBinaryVersion;
+  header.key = build.key;
+  header.format = format;
+  header.length = static_cast<uint32_t>(length);
+  // written aside and renamed, so another instance never reads half a binary
+  std::string path = binaryPath(build.key), temporary = path + ".tmp";
+  {
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(binary.data(), length);
+    if (!file) {
+      std::cerr << "[Warning] Failed to save a program binary to " << temporary << std::endl;
+      return;
+    }
+  }
+  std::error_code error;
+  std::filesystem::rename(temporary, path, error);
+}
+}
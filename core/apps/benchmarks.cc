@@ -0,0 +1,359 @@
+#include <core/action.h>
+#include <core/board-geometry.h>
+#include <core/distance-field.h>
+#include <core/game-state.h>
+#include <core/input-adapter.h>
+#include <core/map-generator.h>
+#include <core/map.h>
+#include <core/philox.h>
+#include <core/profiler.h>
+#include <core/timing.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// headless microbenchmarks of the game's hot paths; results go to stdout and, with --json, to a file that can
+// be compared between releases
+struct Result {
+  std::string name;
+  uint64_t iterations{};
+  double nsPerOp{}, minNsPerOp{}, maxNsPerOp{};
+};
+
+// keeps the compiler from dropping a computation whose result is never used
+template <typename T>
+inline void keep(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// each benchmark is a function running its operation n times; n grows until a run takes long enough, then
+// the run is repeated and the median, fastest and slowest time per operation are kept
+class Runner {
+  public:
+    Runner(double minSeconds, int repetitions, std::string filter)
+      : minSeconds(minSeconds), repetitions(std::max(1, repetitions)), filter(std::move(filter)) {
+    }
+
+    template <typename Fn>
+    void run(const std::string& name, Fn&& fn) {
+      if (!filter.empty() && name.find(filter) == std::string::npos)
+        return;
+      auto target = static_cast<int64_t>(minSeconds * 1e9 / repetitions);
+      uint64_t n = 1;
+      for (;;) {
+        int64_t elapsed = time(fn, n);
+        if (elapsed >= target || n >= (uint64_t{1} << 40))
+          break;
+        double scale = elapsed > 0 ? 1.4 * static_cast<double>(target) / static_cast<double>(elapsed) : 100.0;
+        n = static_cast<uint64_t>(static_cast<double>(n) * std::clamp(scale, 2.0, 100.0));
+      }
+      std::vector<double> perOp;
+      for (int r = 0; r < repetitions; r++)
+        perOp.push_back(static_cast<double>(time(fn, n)) / static_cast<double>(n));
+      std::sort(perOp.begin(), perOp.end());
+      Result& result = results.emplace_back();
+      result.name = name;
+      result.iterations = n;
+      result.nsPerOp = perOp[perOp.size() / 2];
+      result.minNsPerOp = perOp.front();
+      result.maxNsPerOp = perOp.back();
+      std::cout << std::format("{:<36} {:>14.1f} ns/op  (min {:.1f}, max {:.1f}, {} iterations)", name,
+                               result.nsPerOp, result.minNsPerOp, result.maxNsPerOp, n) << std::endl;
+    }
+
+    bool writeJson(const std::string& path) const {
+      std::ofstream out(path);
+      if (!out) {
+        std::cerr << std::format("Failed to create {}", path) << std::endl;
+        return false;
+      }
+      char date[32];
+      std::time_t now = std::time(nullptr);
+      std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+#ifdef NDEBUG
+      bool optimized = true;
+#else
+      bool optimized = false;
+#endif
+      out << "{\n  \"context\": {\n";
+      out << std::format("    \"date\": \"{}\",\n    \"compiler\": \"{}\",\n    \"ndebug\": {},\n", date, __VERSION__,
+                         optimized);
+      out << std::format("    \"hardware_threads\": {},\n    \"repetitions\": {}\n  }},\n",
+                         std::thread::hardware_concurrency(), repetitions);
+      out << "  \"benchmarks\": [";
+      for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        out << std::format("{}\n    {{\"name\": \"{}\", \"iterations\": {}, \"ns_per_op\": {:.3f}, "
+                           "\"min_ns_per_op\": {:.3f}, \"max_ns_per_op\": {:.3f}}}", i ? "," : "", r.name,
+                           r.iterations, r.nsPerOp, r.minNsPerOp, r.maxNsPerOp);
+      }
+      out << "\n  ]\n}\n";
+      return static_cast<bool>(out);
+    }
+
+  private:
+    template <typename Fn>
+    static int64_t time(Fn& fn, uint64_t n) {
+      int64_t begin = core::monotonicNs();
+      fn(n);
+      return core::monotonicNs() - begin;
+    }
+
+    double minSeconds;
+    int repetitions;
+    std::string filter;
+    std::vector<Result> results;
+};
+
+// uniformly drawn points of a width x height map, a power of two of them so they can be cycled with a mask
+static std::vector<core::Point> randomPoints(int width, int height, uint64_t seed) {
+  core::Philox4x32 rng(seed);
+  std::vector<core::Point> points(1 << 16);
+  for (size_t i = 0; i < points.size(); i++) {
+    auto block = rng(0, i);
+    points[i] = core::Point(static_cast<int>(core::Philox4x32::below(block[0], width)),
+                            static_cast<int>(core::Philox4x32::below(block[1], height)));
+  }
+  return points;
+}
+
+static void mapBenchmarks(Runner& runner) {
+  // a random walk over the whole map, roughly what the generator leaves behind
+  for (int size : {64, 256, 1024, 4096}) {
+    std::vector<core::Point> walk = randomPoints(size, size, size);
+    walk.resize(std::min<size_t>(walk.size(), static_cast<size_t>(size) * 4));
+    runner.run(std::format("map/construct/{}x{}", size, size), [&](uint64_t n) {
+      for (uint64_t i = 0; i < n; i++) {
+        core::Map map(size, size, walk[0]);
+        for (size_t j = 0; j < walk.size(); j++)
+          map.setTile(walk[j], static_cast<core::TileState>(1 + j % 3));
+        map.addExit(walk.back());
+        keep(map.chunkCount());
+      }
+    });
+  }
+  for (int length : {40, 400, 4000}) {
+    core::MapGenerator generator(1);
+    uint64_t seed = 1;
+    runner.run(std::format("map/generate/4x{}", length), [&](uint64_t n) {
+      for (uint64_t i = 0; i < n; i++) {
+        core::Map map = generator.generate({4, length, length + 1}, seed++);
+        keep(map.chunkCount());
+      }
+    });
+  }
+
+  core::Map map = core::MapGenerator(1).generate({8, 4000, 8000}, 7);
+  std::vector<core::Point> points = randomPoints(map.getWidth(), map.getHeight(), 11);
+  size_t mask = points.size() - 1;
+  runner.run("map/tile", [&](uint64_t n) {
+    unsigned sum = 0;
+    for (uint64_t i = 0; i < n; i++)
+      sum += static_cast<unsigned>(map.tile(points[i & mask]));
+    keep(sum);
+  });
+  runner.run("map/isExit", [&](uint64_t n) {
+    unsigned sum = 0;
+    for (uint64_t i = 0; i < n; i++)
+      sum += map.isExit(points[i & mask]);
+    keep(sum);
+  });
+  // queries that land on a chunk holding an exit, where the directory flag alone does not answer
+  std::vector<core::Point> nearExits;
+  for (auto exit : map.getExits()) {
+    for (int d = -2; d <= 2; d++) {
+      core::Point p(exit.x + d, exit.y);
+      if (map.contains(p))
+        nearExits.push_back(p);
+    }
+  }
+  runner.run("map/isExit/near-exit", [&](uint64_t n) {
+    unsigned sum = 0;
+    for (uint64_t i = 0; i < n; i++)
+      sum += map.isExit(nearExits[i % nearExits.size()]);
+    keep(sum);
+  });
+  runner.run("distance-field/build", [&](uint64_t n) {
+    core::DistanceField field;
+    for (uint64_t i = 0; i < n; i++) {
+      field.build(map);
+      keep(field.solutionLength());
+    }
+  });
+}
+
+static void gameStateBenchmarks(Runner& runner) {
+  core::Map map = core::MapGenerator(1).generate({8, 4000, 8000}, 7);
+  // tiles a Black block can stand on, so every update runs the full set of checks
+  std::vector<core::Point> safe;
+  map.forEachTile([&](int x, int y, core::TileState tile) {
+    if (tile != core::TileState::White && !map.isExit(x, y))
+      safe.emplace_back(x, y);
+  });
+  core::ManualClock clock;
+  core::GameState state(map.getStart(), clock);
+  runner.run("game-state/update", [&](uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+      state.pos = safe[i % safe.size()];
+      state.update(map);
+      keep(state.ending);
+    }
+    state.ending = core::GameEnd::Running;
+  });
+  runner.run("game-state/apply+update", [&](uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+      state.pos = safe[i % safe.size()];
+      state.color = core::TileState::Black;
+      state.ending = core::GameEnd::Running;
+      state.apply(map, core::ActionEvent{static_cast<core::Action>(i % 4)});
+      state.update(map);
+      keep(state.ending);
+    }
+  });
+}
+
+static void queueBenchmarks(Runner& runner) {
+  auto queue = std::make_unique<core::ActionQueue>();
+  core::ActionEvent event{core::Action::Up};
+  runner.run("action-queue/push+pop", [&](uint64_t n) {
+    core::ActionQueue::Event out;
+    for (uint64_t i = 0; i < n; i++) {
+      queue->tryPush(event, 0);
+      queue->tryPop(out);
+      keep(out.seq);
+    }
+  });
+  // an input thread pushing while the simulation thread drains, as in the game; a full ring is retried
+  runner.run("action-queue/contended", [&](uint64_t n) {
+    std::thread consumer([&]() {
+      for (uint64_t received = 0; received < n;) {
+        size_t count = queue->drain([](const core::ActionQueue::Event& e) { keep(e.seq); });
+        received += count;
+        if (!count)
+          std::this_thread::yield();
+      }
+    });
+    for (uint64_t i = 0; i < n; i++) {
+      while (!queue->tryPush(event, 0))
+        std::this_thread::yield();
+    }
+    consumer.join();
+  });
+}
+
+static void inputBenchmarks(Runner& runner) {
+  // a recorded classifier stream: gesture ids with runs of kInvalidGesture in between, ending on a gesture
+  core::Philox4x32 rng(3);
+  std::string stream;
+  uint64_t gestures = 0;
+  for (uint64_t i = 0; i < (1 << 16); i++) {
+    auto block = rng(0, i);
+    bool invalid = core::Philox4x32::below(block[0], 10) < 3 && i + 1 < (1 << 16);
+    stream += std::format("{}\n", invalid ? core::kInvalidGesture : static_cast<int>(block[1] % 5));
+    gestures += !invalid;
+  }
+  runner.run("input/gesture-id-filter", [&](uint64_t n) {
+    for (uint64_t done = 0; done < n;) {
+      FILE* in = fmemopen(stream.data(), stream.size(), "r");
+      core::GestureIdFilter filter;
+      int64_t captureNs;
+      for (uint64_t i = 0; i < gestures && done < n; i++, done++)
+        keep(filter.next(in, captureNs));
+      fclose(in);
+    }
+  });
+}
+
+static void geometryBenchmarks(Runner& runner) {
+  core::BoardGeometry board;
+  glm::vec3 color(0.5f, 0.5f, 0.5f);
+  runner.run("board/add-square", [&](uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+      if ((i & 4095) == 0) {
+        board.positions.clear();
+        board.colors.clear();
+        board.idx.clear();
+      }
+      board.addSquare(static_cast<float>(i & 63), static_cast<float>((i >> 6) & 63), 0.0f, 1.0f, 1.0f, color);
+    }
+    keep(board.idx.size());
+  });
+  core::Map map = core::MapGenerator(1).generate({1, 30, 50}, 5);
+  runner.run("board/add-tiles/game-map", [&](uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+      core::BoardGeometry tiles;
+      tiles.addTiles(map);
+      keep(tiles.idx.size());
+    }
+  });
+}
+
+static void profilerBenchmarks(Runner& runner) {
+  auto& profiler = core::Profiler::instance();
+  runner.run("profiler/zone/off", [&](uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+      HCI_PROFILE_ZONE("benchmark");
+      keep(i);
+    }
+  });
+  profiler.start();
+  runner.run("profiler/zone/on", [&](uint64_t n) {
+    for (uint64_t i = 0; i < n; i++) {
+      HCI_PROFILE_ZONE("benchmark");
+      keep(i);
+      // as a frame would, before the thread's ring fills
+      if ((i & 4095) == 4095)
+        profiler.clear();
+    }
+  });
+  profiler.stop();
+  profiler.clear();
+}
+
+static void usage() {
+  std::cout << "Usage: benchmarks [--json file] [--filter name part] [--min-time seconds] [--repetitions n]"
+            << std::endl;
+}
+
+int main(int argc, char** argv) {
+  std::string json, filter;
+  double minSeconds = 0.5;
+  int repetitions = 5;
+  for (int i = 1; i < argc; i++) {
+    bool hasValue = i + 1 < argc;
+    if (!strcmp(argv[i], "--json") && hasValue)
+      json = argv[++i];
+    else if (!strcmp(argv[i], "--filter") && hasValue)
+      filter = argv[++i];
+    else if (!strcmp(argv[i], "--min-time") && hasValue)
+      minSeconds = std::stod(argv[++i]);
+    else if (!strcmp(argv[i], "--repetitions") && hasValue)
+      repetitions = std::stoi(argv[++i]);
+    else {
+      usage();
+      return 0;
+    }
+  }
+#ifndef NDEBUG
+  std::cerr << "Warning: assertions are on, configure with -DCMAKE_BUILD_TYPE=Release for meaningful numbers"
+            << std::endl;
+#endif
+  Runner runner(minSeconds, repetitions, filter);
+  mapBenchmarks(runner);
+  gameStateBenchmarks(runner);
+  queueBenchmarks(runner);
+  inputBenchmarks(runner);
+  geometryBenchmarks(runner);
+  profilerBenchmarks(runner);
+  if (!json.empty() && !runner.writeJson(json))
+    return 1;
+  return 0;
+}
@@ -0,0 +1,135 @@
+#include <core/distance-field.h>
+#include <core/game-batch.h>
+#include <core/map-generator.h>
+#include <core/philox.h>
+#include <core/timing.h>
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// headless games for difficulty tuning: bots play many runs on each of a pool of generated maps, and the
+// share of runs that reach an exit rates how hard a map is
+struct Options {
+  int maps = 1000;
+  int games = 100;
+  core::MapSpec spec;
+  uint64_t seed = 1;
+  int threads = 0;
+  // random: any direction every tick; safe: a random direction among the tiles it would survive on
+  bool safe = true;
+  bool perMap = false;
+};
+
+static void usage() {
+  std::cout << "Usage: game-sim [--maps n] [--games runs per map] [--paths n] [--length min max] [--seed s]"
+            << std::endl;
+  std::cout << "                [--threads n] [--policy random|safe] [--per-map]" << std::endl;
+}
+
+int main(int argc, char** argv) {
+  Options options;
+  for (int i = 1; i < argc; i++) {
+    bool hasValue = i + 1 < argc;
+    if (!strcmp(argv[i], "--maps") && hasValue)
+      options.maps = std::max(1, std::stoi(argv[++i]));
+    else if (!strcmp(argv[i], "--games") && hasValue)
+      options.games = std::max(1, std::stoi(argv[++i]));
+    else if (!strcmp(argv[i], "--paths") && hasValue)
+      options.spec.numPaths = std::max(1, std::stoi(argv[++i]));
+    else if (!strcmp(argv[i], "--length") && i + 2 < argc) {
+      options.spec.minPathLen = std::max(1, std::stoi(argv[++i]));
+      options.spec.maxPathLen = std::max(options.spec.minPathLen + 1, std::stoi(argv[++i]));
+    }
+    else if (!strcmp(argv[i], "--seed") && hasValue)
+      options.seed = std::stoull(argv[++i]);
+    else if (!strcmp(argv[i], "--threads") && hasValue)
+      options.threads = std::stoi(argv[++i]);
+    else if (!strcmp(argv[i], "--policy") && hasValue)
+      options.safe = strcmp(argv[++i], "random") != 0;
+    else if (!strcmp(argv[i], "--per-map"))
+      options.perMap = true;
+    else {
+      usage();
+      return 0;
+    }
+  }
+
+  int64_t begin = core::monotonicNs();
+  core::MapGenerator generator(options.threads);
+  std::vector<core::Map> maps = generator.generateBatch(options.spec, options.seed, options.maps);
+  core::GameBatch batch;
+  std::vector<int> solutions;
+  core::DistanceField field;
+  for (const auto& map : maps) {
+    field.build(map);
+    solutions.push_back(field.solutionLength());
+    int level = batch.addLevel(map);
+    for (int g = 0; g < options.games; g++)
+      batch.addGame(level);
+  }
+  int64_t generated = core::monotonicNs();
+
+  // moves drawn from Philox(seed) at (game, tick), so a run does not depend on how games are split up
+  core::Philox4x32 rng(options.seed);
+  bool safe = options.safe;
+  auto policy = [&rng, safe](const core::GameBatch& batch, int first, int last, int64_t tick, uint8_t* actions) {
+    for (int i = first; i < last; i++) {
+      if (batch.ending(i) != core::GameEnd::Running) {
+        actions[i - first] = core::GameBatch::kIdle;
+        continue;
+      }
+      uint32_t bits = rng(static_cast<uint64_t>(i), static_cast<uint64_t>(tick))[0];
+      int choice = static_cast<int>(core::Philox4x32::below(bits, 4));
+      if (safe) {
+        core::Point pos = batch.position(i);
+        core::TileState color = batch.color(i);
+        int options[4], count = 0;
+        for (int d = 0; d < 4; d++) {
+          core::TileState next = batch.tile(batch.level(i), pos.x + core::moveSteps[d].x,
+                                                pos.y + core::moveSteps[d].y);
+          if (next == core::TileState::Gray || next == color)
+            options[count++] = d;
+        }
+        if (count > 0)
+          choice = options[core::Philox4x32::below(bits, count)];
+      }
+      actions[i - first] = static_cast<uint8_t>(choice);
+    }
+  };
+  auto maxTicks = static_cast<int64_t>(core::kMaxGameTime / core::kOperationInterval) + 1;
+  batch.run(policy, 0.0, core::kOperationInterval, maxTicks, options.threads);
+  int64_t simulated = core::monotonicNs();
+
+  auto summary = batch.summary();
+  double seconds = static_cast<double>(simulated - generated) / 1e9;
+  std::cout << std::format("{} maps generated and solved in {:.1f} ms", options.maps, (generated - begin) / 1e6)
+            << std::endl;
+  std::cout << std::format("{} games, {} moves in {:.3f} s: {:.0f} games/s, {:.0f} moves/s", summary.games,
+                           summary.moves, seconds, summary.games / seconds, summary.moves / seconds) << std::endl;
+  std::cout << std::format("reached an exit {:.1f}%, failed {:.1f}%, timed out {:.1f}%",
+                           100.0 * summary.reachedExit / summary.games, 100.0 * summary.failed / summary.games,
+                           100.0 * (summary.finished - summary.reachedExit) / summary.games) << std::endl;
+
+  // games of a map are consecutive
+  std::vector<double> exitRates(options.maps);
+  for (int m = 0; m < options.maps; m++) {
+    int wins = 0;
+    for (int g = 0; g < options.games; g++)
+      wins += batch.reachedExit(m * options.games + g);
+    exitRates[m] = static_cast<double>(wins) / options.games;
+    if (options.perMap)
+      std::cout << std::format("seed {} exit rate {:.3f}, shortest solution {}", options.seed + m, exitRates[m],
+                               solutions[m]) << std::endl;
+  }
+  int unsolvable = static_cast<int>(std::count(solutions.begin(), solutions.end(), core::DistanceField::kUnreachable));
+  if (unsolvable)
+    std::cout << std::format("{} of {} maps cannot be finished", unsolvable, options.maps) << std::endl;
+  std::sort(exitRates.begin(), exitRates.end());
+  auto quantile = [&](double q) { return exitRates[static_cast<size_t>(q * (exitRates.size() - 1))]; };
+  std::cout << std::format("exit rate per map: min {:.3f}, p10 {:.3f}, median {:.3f}, p90 {:.3f}, max {:.3f}",
+                           quantile(0.0), quantile(0.1), quantile(0.5), quantile(0.9), quantile(1.0)) << std::endl;
+  return 0;
+}
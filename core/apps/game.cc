@@ -1,61 +1,47 @@
 #include <array>
-#include <condition_variable>
+#include <cmath>
 #include <cstring>
 #include <format>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <ogl-render/ogl-ctx.h>
+#include <ogl-render/gl-ext.h>
+#include <ogl-render/gl-state.h>
+#include <ogl-render/gpu-profiler.h>
+#include <ogl-render/program-cache.h>
 #include <ogl-render/shader-prog.h>
+#include <ogl-render/stream-buffer.h>
+#include <ogl-render/texture.h>
+#include <core/action.h>
+#include <core/board-geometry.h>
+#include <core/distance-field.h>
+#include <core/game-simulation.h>
+#include <core/gesture-pipeline.h>
+#include <core/input-adapter.h>
+#include <core/latency-trace.h>
+#include <core/level-pack.h>
+#include <core/map-generator.h>
+#include <core/map.h>
+#include <core/profiler.h>
+#include <core/serial-reader.h>
+#include <core/session-log.h>
+#include <core/session-replay.h>
 #include <iostream>
 #include <iostream>
 #include <vector>
 #include <random>
+#include <csignal>
 #include <sys/stat.h>
-#include <queue>
+#include <thread>
 #define ERROR(msg) do {std::cout << std::format("Error: {}", msg) << std::endl; exit(1);} while(0)
 
 using namespace opengl;
-
-struct Range {
-  int begin;
-  int end;
-};
-
-class RandomGenerator {
-  public:
-    RandomGenerator() : m_gen(std::random_device{}()) {
-    }
-    int generate(int min, int max) {
-      int rnd = distrib(m_gen);
-      return rnd % (max - min) + min;
-    }
-    int generate(Range range) {
-      int rnd = distrib(m_gen);
-      return rnd % (range.end - range.begin) + range.begin;
-    }
-
-  private:
-    std::uniform_int_distribution<> distrib;
-    std::mt19937 m_gen;
-};
-
-struct Point {
-  Point() = default;
-  Point(int x, int y) : x(x), y(y) {
-  }
-  int x{};
-  int y{};
-};
-
-const std::array<Point, 4> coordChanges{
-  Point(0, -1),
-  Point(0, 1),
-  Point(-1, 0),
-  Point(1, 0),
-};
-
-enum class Action : uint8_t { Up, Down, Left, Right, Switch };
-enum class TileState : uint8_t { Empty = 0, Gray = 1, Black = 2, White = 3 };
+using core::Action;
+using core::GameEnd;
+using core::InputAdapter;
+using core::Map;
+using core::Point;
+using core::TileState;
 
 void clearScreen() {
 #ifdef WINDOWS
@@ -66,259 +52,12 @@ void clearScreen() {
 #endif
 }
 
-class Map : NonCopyable {
+// the window's clock, started by glfwInit
+class GlfwClock final : public core::Clock {
   public:
-    [[nodiscard]] TileState tile(int x, int y) const {
-      assert(x >= 0 && x < width && y >= 0 && y < height);
-      return tiles[x * height + y];
-    }
-    TileState& tile(int x, int y) {
-      assert(x >= 0 && x < width && y >= 0 && y < height);
-      return tiles[x * height + y];
-    }
-    [[nodiscard]] TileState tile(Point p) const {
-      assert(p.x >= 0 && p.x < width && p.y >= 0 && p.y < height);
-      return tiles[p.x * height + p.y];
-    }
-    TileState& tile(Point p) {
-      assert(p.x >= 0 && p.x < width && p.y >= 0 && p.y < height);
-      return tiles[p.x * height + p.y];
-    }
-    Map(int numPaths, int minPathLen, int maxPathLen) {
-      std::vector<Action> actions;
-      std::vector<int> actionLengths(numPaths);
-      for (int i = 0; i < numPaths; i++) {
-        int pathLen = randGen.generate(minPathLen, maxPathLen);
-        for (int j = 0; j < pathLen; j++) {
-          Action action = static_cast<Action>(randGen.generate(0, 4));
-          actions.push_back(action);
-          actionLengths[i] = pathLen;
-        }
-      }
-      start = computeMapInfo(actions, actionLengths, width, height);
-      tiles.resize(width * height);
-      int curPathStart = 0;
-      TileState curColor = TileState::Black;
-      for (auto len : actionLengths) {
-        Point pos{start};
-        for (int i = curPathStart; i < curPathStart + len; ++i) {
-          Action action = actions[i];
-          if (tile(pos) != TileState::Empty || action == Action::Switch)
-            tile(pos) = TileState::Gray;
-          else
-            tile(pos) = curColor;
-          if (action == Action::Switch) {
-            if (curColor == TileState::Black)
-              curColor = TileState::White;
-            else
-              curColor = TileState::Black;
-            continue;
-          }
-          pos = {
-            pos.x + coordChanges[static_cast<int>(action)].x,
-            pos.y + coordChanges[static_cast<int>(action)].y
-          };
-        }
-        tile(pos.x, pos.y) = curColor;
-        curPathStart += len;
-        exits.push_back(pos);
-        assert(tile(pos.x, pos.y) != TileState::Empty);
-      }
-    }
-
-    Map(Map&&other) noexcept
-      : tiles(std::move(other.tiles)), start(other.start),
-        width(other.width), height(other.height) {
-      other.width = 0;
-      other.height = 0;
-    }
-
-    Map& operator=(Map&&other) noexcept {
-      if (this != &other) {
-        tiles = std::move(other.tiles);
-        start = other.start;
-        width = other.width;
-        height = other.height;
-        other.width = 0;
-        other.height = 0;
-      }
-      return *this;
-    }
-
-    void getMapInfo() const {
-      std::cout << std::format("Map width: {}, height: {}", width, height) << std::endl;
-      std::cout << std::format("Start point: ({}, {})", start.x, start.y) << std::endl;
+    [[nodiscard]] double now() const override {
+      return glfwGetTime();
     }
-    [[nodiscard]] Point getStart() const {
-      return start;
-    }
-    [[nodiscard]] int getWidth() const {
-      return width;
-    }
-
-    [[nodiscard]] int getHeight() const {
-      return height;
-    }
-
-    [[nodiscard]] const std::vector<Point>& getExits() const {
-      return exits;
-    }
-
-    [[nodiscard]] bool isExit(int i, int j) const {
-      for (const auto&ex : exits)
-        if (ex.x == i && ex.y == j)
-          return true;
-      return false;
-    }
-
-  private:
-    std::vector<TileState> tiles;
-    std::vector<Point> exits;
-    Point start;
-    int width, height;
-    static Point computeMapInfo(const std::vector<Action>&actions,
-                                const std::vector<int>&actionLengths,
-                                int&width,
-                                int&height) {
-      Point currentPos = {0, 0};
-      int minX = 0, maxX = 0, minY = 0, maxY = 0;
-      int curPathStart = 0;
-      for (auto len : actionLengths) {
-        Point pos{0, 0};
-        for (int i = curPathStart; i < curPathStart + len; ++i) {
-          Action action = actions[i];
-          if (action == Action::Switch)
-            continue;
-          pos = {
-            pos.x + coordChanges[static_cast<int>(action)].x,
-            pos.y + coordChanges[static_cast<int>(action)].y
-          };
-          minX = std::min(minX, pos.x);
-          maxX = std::max(maxX, pos.x);
-          minY = std::min(minY, pos.y);
-          maxY = std::max(maxY, pos.y);
-        }
-        curPathStart += len;
-      }
-      width = maxX - minX + 1;
-      height = maxY - minY + 1;
-      return {-minX, -minY};
-    }
-    RandomGenerator randGen;
-};
-
-constexpr float kOperationInterval = 0.2f; // sec
-constexpr float kMaxGameTime = 60.0f; // sec
-
-enum class GameEnd {
-  Finished,
-  Failed,
-  Running,
-};
-
-struct GameState {
-  explicit GameState(Point p) : pos(p), time(glfwGetTime()), startTime(time) {
-  }
-  void move(const Map&map, Action action) {
-    lastOperationPos = pos;
-    lastOperationTime = glfwGetTime();
-    if (action == Action::Up)
-      pos.x--;
-    else if (action == Action::Down)
-      pos.x++;
-    else if (action == Action::Left)
-      pos.y--;
-    else if (action == Action::Right)
-      pos.y++;
-    else if (action == Action::Switch) {
-      if (color == TileState::Black)
-        color = TileState::White;
-      else
-        color = TileState::Black;
-    }
-    else
-      ERROR("unknown action");
-  }
-  void update(const Map&map) {
-    time = glfwGetTime();
-    if (pos.x < 0 || pos.x >= map.getWidth() || pos.y < 0 || pos.y >= map.getHeight())
-      ending = GameEnd::Failed;
-    if (color != TileState::Black && color != TileState::White)
-      ERROR("invalid color");
-    if (map.tile(pos) == TileState::Empty)
-      ending = GameEnd::Failed;
-    if (map.tile(pos) == TileState::Black && color == TileState::White)
-      ending = GameEnd::Failed;
-    if (map.tile(pos) == TileState::White && color == TileState::Black)
-      ending = GameEnd::Failed;
-    for (auto end : map.getExits()) {
-      if (pos.x == end.x && pos.y == end.y) {
-        ending = GameEnd::Finished;
-        return;
-      }
-    }
-    if (time > startTime + kMaxGameTime) {
-      ending = GameEnd::Finished;
-      return;
-    }
-    if (time > lastOperationTime + kOperationInterval) {
-      displayPos = glm::vec2(
-        -1.f + static_cast<float>(pos.x) * 2.0 / map.getWidth(),
-        -1.f + static_cast<float>(pos.y) * 2.0 / map.getHeight()
-      );
-    }
-    else {
-      float ratio = (time - lastOperationTime) / kOperationInterval;
-      float lerp_x = (1.f - ratio) * static_cast<float>(lastOperationPos.x) + pos.x * ratio;
-      float lerp_y = (1.f - ratio) * static_cast<float>(lastOperationPos.y) + pos.y * ratio;
-      displayPos = glm::vec2(-1.f + lerp_x * 2.f / map.getWidth(), -1.f + lerp_y * 2.f / map.getHeight());
-    }
-  }
-  GameEnd ending{GameEnd::Running};
-  Point pos, lastOperationPos{};
-  TileState color{TileState::Black};
-  glm::vec2 displayPos{};
-  float time{}, lastOperationTime{}, startTime{};
-};
-
-template <typename T> class ThreadSafeQueue {
-  public:
-  ThreadSafeQueue() = default;
-  bool empty() {
-    std::lock_guard<std::mutex> lk(mtx);
-    return q.empty();
-  }
-  void push(T v) {
-    std::lock_guard<std::mutex> lk(mtx);
-    q.push(v);
-  }
-  void ImmPush(T v) { q.push(v); }
-  bool TryPop(T &v) {
-    std::lock_guard<std::mutex> lk(mtx);
-    if (q.empty())
-      return false;
-    v = q.front();
-    q.pop();
-    return true;
-  }
-  void WaitPop(T &v) {
-    std::unique_lock<std::mutex> lk(mtx);
-    cond.wait(lk, [this]() -> bool { return !q.empty(); });
-    v = q.front();
-    q.pop();
-    lk.unlock();
-  }
-
-  private:
-  std::mutex mtx;
-  std::condition_variable cond;
-  std::queue<T> q;
-};
-
-struct InputAdapter {
-  virtual void inputAction() = 0;
-  virtual ~InputAdapter() = default;
-  ThreadSafeQueue<Action> buffer;
 };
 
 bool initGLFW(GLFWwindow*&window) {
@@ -340,34 +79,16 @@ bool initGLFW(GLFWwindow*&window) {
   return true;
 }
 
-struct DrawBoard {
-  std::vector<glm::vec3> positions;
-  std::vector<glm::vec3> colors;
-  std::vector<uint> idx;
-  void addSquare(float x, float y, float z, float width, float height, const glm::vec3&color) {
-    int num_vertices = positions.size();
-    positions.emplace_back(x, y, z);
-    positions.emplace_back(x + width, y, z);
-    positions.emplace_back(x + width, y + height, z);
-    positions.emplace_back(x, y + height, z);
-    for (int i = 0; i < 4; ++i)
-      colors.push_back(color);
-    idx.push_back(num_vertices);
-    idx.push_back(num_vertices + 1);
-    idx.push_back(num_vertices + 2);
-    idx.push_back(num_vertices);
-    idx.push_back(num_vertices + 2);
-    idx.push_back(num_vertices + 3);
-  }
-};
-
 class PythonSerialAdapter final : public InputAdapter {
   public:
-    explicit PythonSerialAdapter(const std::string&pythonScript) : pipe(
-      popen(std::format("python {}", pythonScript).c_str(), "r"),
+    // command prints gesture ids like hand_side.py, e.g. "python hand_side.py" or "input-gen gestures"
+    PythonSerialAdapter(const std::string&command, const std::string&recordPath) : pipe(
+      popen(command.c_str(), "r"),
       pclose) {
       if (pipe == nullptr)
         ERROR("failed to open python script");
+      if (!recordPath.empty() && !log.open(recordPath))
+        ERROR("failed to create session log");
       thread = std::make_unique<std::thread>([this]() { inputAction(); });
     }
     void inputAction() override {
@@ -378,30 +99,19 @@ class PythonSerialAdapter final : public InputAdapter {
           ERROR("unexpected end of pipe");
         printf("%c\n", c);
       }
-      int v = filterInput();
+      int64_t captureNs;
+      int v = filter.next(pipe.get(), captureNs);
       if (v == -1)
         ERROR("unexpected end of pipe");
       while (running) {
-        switch (v) {
-          case 0:
-            buffer.push(Action::Left);
-            break;
-          case 1:
-            buffer.push(Action::Up);
-            break;
-          case 2:
-            buffer.push(Action::Down);
-            break;
-          case 3:
-            buffer.push(Action::Right);
-            break;
-          case 4:
-            buffer.push(Action::Switch);
-            break;
-          default:
-            ERROR("unknown input");
-        }
-        v = filterInput();
+        Action action;
+        if (!core::gestureToAction(v, action))
+          ERROR("unknown input");
+        core::ActionEvent event{action};
+        if (log.isOpen())
+          log.writeAction(captureNs, event);
+        buffer.tryPush(event, captureNs);
+        v = filter.next(pipe.get(), captureNs);
       }
     }
     ~PythonSerialAdapter() noexcept override {
@@ -411,143 +121,604 @@ class PythonSerialAdapter final : public InputAdapter {
     }
 
   private:
-    int filterInput() const {
-      static int prev = 998;
-      int v = 998;
-      if (fscanf(pipe.get(), "%d", &v) == EOF) {
-        std::cerr << "Warning: reaching end of file" << std::endl;
-        return -1;
-      }
-      printf("%d\n", v);
-      while (v == prev || v == 998) {
-        prev = v;
-        if (fscanf(pipe.get(), "%d", &v) == EOF)
-          return -1;
-        printf("%d\n", v);
+    std::atomic_bool running{true};
+    std::unique_ptr<std::thread> thread;
+    std::unique_ptr<FILE, decltype(&pclose)> pipe;
+    core::GestureIdFilter filter{true};
+    core::SessionLogWriter log;
+};
+
+constexpr float kScoreThreshold = 0.95f;
+
+// reads the tracking device and classifies gestures in process, replacing hand_side.py
+// with speculation on, gestures are acted on from a partial window and confirmed or retracted later
+class NativeGestureAdapter final : public InputAdapter {
+  public:
+    NativeGestureAdapter(const std::string&device, const std::string&weights, bool speculate,
+                         const std::string&recordPath) : reader(device) {
+      if (!model.load(weights))
+        ERROR("failed to load gesture model");
+      if (!reader.open())
+        ERROR("failed to open serial device");
+      if (!recordPath.empty() && !log.open(recordPath))
+        ERROR("failed to create session log");
+      core::SpeculativeGestureDetector::Config config;
+      config.threshold = kScoreThreshold;
+      config.speculate = speculate;
+      pipeline = std::make_unique<core::GesturePipeline>(model, config);
+      reader.start();
+      thread = std::make_unique<std::thread>([this]() { inputAction(); });
+    }
+    void inputAction() override {
+      core::TimedEvent<core::KeypointFrame> frame;
+      while (running) {
+        if (!reader.frames.waitFor(frame, 100'000'000)) {
+          if (reader.finished())
+            ERROR("serial device closed");
+          continue;
+        }
+        pipeline->push(frame.value, frame.captureNs, buffer, log.isOpen() ? &log : nullptr);
       }
-      return v;
     }
+    ~NativeGestureAdapter() noexcept override {
+      running = false;
+      if (thread->joinable())
+        thread->join();
+      reader.stop();
+      if (const auto& stats = pipeline->detector().stats(); stats.provisional)
+        std::cout << std::format("Speculation: {} provisional gestures, {} confirmed, {} retracted, "
+                                 "{:.1f} frames saved per confirmation", stats.provisional, stats.confirmed,
+                                 stats.retracted,
+                                 stats.confirmed ? static_cast<double>(stats.framesSaved) / stats.confirmed : 0.0)
+                  << std::endl;
+    }
+
+  private:
+    core::SerialKeypointReader reader;
+    core::GestureModel model;
+    std::unique_ptr<core::GesturePipeline> pipeline;
+    core::SessionLogWriter log;
     std::atomic_bool running{true};
     std::unique_ptr<std::thread> thread;
-    std::unique_ptr<FILE, decltype(&pclose)> pipe;
 };
 
+// what 2d-tiles.vs draws of one tile
+struct TileInstance {
+  // lower left corner, in tiles
+  glm::vec2 tile;
+  // TileState, kExit or kBlock + 0 (Black) / 1 (White)
+  uint32_t kind;
+
+  static constexpr uint32_t kExit = 4;
+  static constexpr uint32_t kBlock = 5;
+};
+
+static opengl::ProgramSource shaderFiles(const char* vs, const char* fs) {
+  return {std::format("{}/{}", SHADER_DIR, vs), std::format("{}/{}", SHADER_DIR, fs), ""};
+}
+
+// a game that cannot build its programs cannot draw
+static std::unique_ptr<ShaderProg> loadProgram(opengl::ProgramCache&programs, const opengl::ProgramSource&source) {
+  auto shader = programs.load(source);
+  if (!shader)
+    ERROR(std::format("failed to build the program of {}", source.vs_path));
+  return shader;
+}
+
+static opengl::ProgramSource tileProgram() {
+  return shaderFiles("2d-tiles.vs", "2d-tiles.fs");
+}
+
+static std::unique_ptr<ShaderProg> tileShader(opengl::ProgramCache&programs, int width, int height) {
+  auto shader = loadProgram(programs, tileProgram());
+  shader->use();
+  shader->initUniformHandles();
+  shader->setVec2f("uMapSize", static_cast<float>(width), static_cast<float>(height));
+  return shader;
+}
+
+// the unit square instances of 2d-tiles.vs are drawn from
+static void addUnitSquare(OpenGLContext&ctx) {
+  std::vector<glm::vec2> corners{glm::vec2(0.0f, 0.0f), glm::vec2(1.0f, 0.0f), glm::vec2(1.0f, 1.0f),
+                                 glm::vec2(0.0f, 1.0f)};
+  ctx.newAttribute("aCorner", corners, 2, 2 * sizeof(float), GL_FLOAT);
+  ctx.ebo.bind();
+  ctx.ebo.passData({0, 1, 2, 0, 2, 3});
+}
+
+// the block, a single 2d-tiles instance written every frame into a stream buffer and drawn over the board
+class BlockSprite {
+  public:
+    static opengl::ProgramSource program() {
+      return tileProgram();
+    }
+
+    BlockSprite(opengl::ProgramCache&programs, int width, int height)
+      : width(width), height(height), shader(tileShader(programs, width, height)) {
+      ctx = std::make_unique<OpenGLContext>();
+      ctx->vao.bind();
+      addUnitSquare(*ctx);
+      stream = std::make_unique<StreamBuffer<TileInstance>>(1);
+      ctx->streamAttribute("aTile", *stream, 2, GL_FLOAT, offsetof(TileInstance, tile), 1);
+      ctx->streamIntegerAttribute("aKind", *stream, 1, GL_UNSIGNED_INT, offsetof(TileInstance, kind), 1);
+    }
+    void update(glm::vec2 displayPos, TileState color) {
+      // displayPos is in normalized device coordinates
+      instance.tile = glm::vec2((displayPos.x + 1.0f) * 0.5f * width, (displayPos.y + 1.0f) * 0.5f * height);
+      instance.kind = TileInstance::kBlock + (color == TileState::Black ? 0 : 1);
+    }
+    void draw() {
+      shader->use();
+      ctx->vao.bind();
+      *stream->begin() = instance;
+      stream->end(1);
+      ctx->drawInstanced(GL_TRIANGLES, 6, 1);
+      stream->fence();
+    }
+    [[nodiscard]] const StreamBuffer<TileInstance>::Stats& stats() const {
+      return stream->stats;
+    }
+
+  private:
+    int width, height;
+    TileInstance instance{glm::vec2(0.0f), TileInstance::kBlock};
+    std::unique_ptr<ShaderProg> shader;
+    std::unique_ptr<OpenGLContext> ctx;
+    std::unique_ptr<StreamBuffer<TileInstance>> stream;
+};
+
+// draws the board (without the block) into the current GL context
+class BoardRenderer {
+  public:
+    virtual void draw() = 0;
+    virtual ~BoardRenderer() = default;
+};
+
+// a board corner in 12 bytes (24 as two float vectors), read by 2d-packed.vs
+struct BoardVertex {
+  // whole tiles, depth in halves (0 or -1 in front), 0
+  opengl::Short4 position;
+  opengl::Unorm8x4 color;
+
+  using Layout = opengl::VertexLayout<opengl::Short4, opengl::Unorm8x4>;
+};
+
+// a square of 4 vertices and 6 indices per tile, taken from a packed level when it was packed with it
+class QuadBoardRenderer final : public BoardRenderer {
+  public:
+    // the corners must be whole tiles in an int16
+    static bool fits(const Map&map) {
+      return std::max(map.getWidth(), map.getHeight()) <= INT16_MAX;
+    }
+
+    static opengl::ProgramSource program() {
+      return shaderFiles("2d-packed.vs", "2d-default.fs");
+    }
+
+    QuadBoardRenderer(opengl::ProgramCache&programs, const Map&map, const core::PackedLevel* packed) {
+      int width = map.getWidth(), height = map.getHeight();
+      shader = loadProgram(programs, program());
+      core::BoardGeometry board;
+      if (packed && !packed->positions.empty())
+        board.append(packed->positions, packed->colors, packed->idx);
+      else
+        board.addTiles(map);
+      // back from normalized device coordinates, where tile corners are whole
+      std::vector<BoardVertex> vertices(board.positions.size());
+      auto pack = [](float v) { return static_cast<int16_t>(std::lround(v)); };
+      for (size_t i = 0; i < vertices.size(); i++) {
+        const glm::vec3&p = board.positions[i];
+        vertices[i].position = {pack((p.x + 1.0f) * 0.5f * width), pack((p.y + 1.0f) * 0.5f * height),
+                                pack(p.z * 2.0f), 0};
+        vertices[i].color = opengl::Unorm8x4::fromColor(board.colors[i]);
+      }
+      bgCtx = std::make_unique<OpenGLContext>();
+      shader->use();
+      shader->initUniformHandles();
+      shader->setVec2f("uMapSize", static_cast<float>(width), static_cast<float>(height));
+      bgCtx->vao.bind();
+      bgCtx->newVertices(vertices, {"aPos", "aColor"});
+      bgCtx->ebo.bind();
+      bgCtx->ebo.passIndices(board.idx, vertices.size());
+    }
+    void draw() override {
+      shader->use();
+      bgCtx->vao.bind();
+      bgCtx->drawIndexed(GL_TRIANGLES);
+    }
+
+  private:
+    std::unique_ptr<ShaderProg> shader{};
+    std::unique_ptr<OpenGLContext> bgCtx;
+};
+
+// one unit square drawn once per tile from a 12 byte record, 2d-tiles.vs places and colors it
+class InstancedBoardRenderer final : public BoardRenderer {
+  public:
+    static opengl::ProgramSource program() {
+      return tileProgram();
+    }
+
+    InstancedBoardRenderer(opengl::ProgramCache&programs, const Map&map)
+      : shader(tileShader(programs, map.getWidth(), map.getHeight())) {
+      std::vector<TileInstance> instances;
+      map.forEachTile([&](int i, int j, TileState state) {
+        uint32_t kind = map.isExit(i, j) ? TileInstance::kExit : static_cast<uint32_t>(state);
+        instances.push_back({glm::vec2(static_cast<float>(i), static_cast<float>(j)), kind});
+      });
+      ctx = std::make_unique<OpenGLContext>();
+      ctx->vao.bind();
+      addUnitSquare(*ctx);
+      tiles = std::make_unique<InstanceBuffer<TileInstance>>(instances, GL_STATIC_DRAW);
+      ctx->instanceAttribute("aTile", *tiles, 2, GL_FLOAT, offsetof(TileInstance, tile));
+      ctx->instanceIntegerAttribute("aKind", *tiles, 1, GL_UNSIGNED_INT, offsetof(TileInstance, kind));
+    }
+    void draw() override {
+      shader->use();
+      ctx->vao.bind();
+      ctx->drawInstanced(GL_TRIANGLES, 6, tiles->count);
+    }
+
+  private:
+    std::unique_ptr<ShaderProg> shader;
+    std::unique_ptr<OpenGLContext> ctx;
+    std::unique_ptr<InstanceBuffer<TileInstance>> tiles;
+};
+
+// the map as an R8UI texture of one byte per tile, drawn by 2d-board.fs over a single quad covering the
+// viewport. A changed tile would only need its texel rewritten, through Texture2D::update.
+class TextureBoardRenderer final : public BoardRenderer {
+  public:
+    static opengl::ProgramSource program() {
+      return shaderFiles("2d-board.vs", "2d-board.fs");
+    }
+
+    TextureBoardRenderer(opengl::ProgramCache&programs, const Map&map) {
+      int width = map.getWidth(), height = map.getHeight();
+      shader = loadProgram(programs, program());
+      std::vector<uint8_t> cells(static_cast<size_t>(width) * height, 0);
+      map.forEachTile([&](int x, int y, TileState) {
+        cells[static_cast<size_t>(y) * width + x] = cell(map, x, y);
+      });
+      tiles = std::make_unique<Texture2D>(width, height, GL_R8UI, GL_RED_INTEGER, GL_UNSIGNED_BYTE, cells.data());
+      // the quad comes from gl_VertexID, the vertex array stays empty
+      ctx = std::make_unique<OpenGLContext>();
+      shader->use();
+      shader->initUniformHandles();
+      shader->setVec2f("uMapSize", static_cast<float>(width), static_cast<float>(height));
+      shader->setInt("uTiles", 0);
+    }
+    void draw() override {
+      shader->use();
+      ctx->vao.bind();
+      tiles->bind(0);
+      OpenGLContext::drawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    }
+
+  private:
+    static uint8_t cell(const Map&map, int x, int y) {
+      return static_cast<uint8_t>(map.tile(x, y)) | (map.isExit(x, y) ? TileInstance::kExit : 0);
+    }
+
+    std::unique_ptr<ShaderProg> shader;
+    std::unique_ptr<Texture2D> tiles;
+    std::unique_ptr<OpenGLContext> ctx;
+};
+
+enum class BoardMode { Quads, Instanced, Texture };
+
 class OglDisplayer {
   public:
-    explicit OglDisplayer(const Map&map) : width(map.getWidth()), height(map.getHeight()) {
+    // programs are kept in shaderCache, compiled every time when it is empty; with profile, the board and the
+    // block are timed on the GPU as well
+    OglDisplayer(const Map&map, const core::PackedLevel* packed, BoardMode mode, const std::string&shaderCache,
+                 bool profile) {
       initGLFW(window);
+      glState.makeCurrent();
       if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
         std::cerr << "Failed to initialize GLAD" << std::endl;
         exit(1);
       }
-      shader = std::make_unique<ShaderProg>(std::format("{}/2d-default.vs", SHADER_DIR).c_str(),
-                                            std::format("{}/2d-default.fs", SHADER_DIR).c_str());
-      for (int i = 0; i < width; ++i) {
-        for (int j = 0; j < height; ++j) {
-          glm::vec3 squareColor;
-          glm::vec3 squarePosition;
-          squarePosition.x = -1.0f + static_cast<float>(i) / width * 2.0f; // Set x position based on column index
-          squarePosition.y = -1.0f + static_cast<float>(j) / height * 2.0f; // Set y position based on row index
-          squarePosition.z = 0.0f;
-          if (map.tile(i, j) == TileState::Empty) continue;
-          if (map.isExit(i, j)) {
-            squareColor = glm::vec3(0.0f, 1.0f, 0.0f);
-            squarePosition.z = -0.5f;
-          }
-          else if (map.tile(i, j) == TileState::Black)
-            squareColor = glm::vec3(0.0f, 0.0f, 0.0f);
-          else if (map.tile(i, j) == TileState::Gray)
-            squareColor = glm::vec3(0.5f, 0.5f, 0.5f);
-          else if (map.tile(i, j) == TileState::White)
-            squareColor = glm::vec3(1.0f, 1.0f, 1.0f);
-          board.addSquare(squarePosition.x,
-                          squarePosition.y,
-                          squarePosition.z,
-                          2.0f / width,
-                          2.0f / height,
-                          squareColor);
-        }
+      opengl::loadExtensions((GLADloadproc)glfwGetProcAddress);
+      if (mode == BoardMode::Texture && std::max(map.getWidth(), map.getHeight()) > Texture2D::maxSize()) {
+        std::cerr << std::format("Warning: a {} x {} map does not fit in a texture, drawing instances",
+                                 map.getWidth(), map.getHeight()) << std::endl;
+        mode = BoardMode::Instanced;
+      }
+      if (mode == BoardMode::Quads && !QuadBoardRenderer::fits(map)) {
+        std::cerr << std::format("Warning: a {} x {} map does not fit in int16 vertices, drawing instances",
+                                 map.getWidth(), map.getHeight()) << std::endl;
+        mode = BoardMode::Instanced;
+      }
+      opengl::ProgramCache programs(shaderCache);
+      // the board's and the block's programs build together
+      opengl::ProgramSource board = mode == BoardMode::Texture ? TextureBoardRenderer::program()
+                                    : mode == BoardMode::Instanced ? InstancedBoardRenderer::program()
+                                    : QuadBoardRenderer::program();
+      programs.prefetch({board, BlockSprite::program()});
+      if (mode == BoardMode::Texture)
+        renderer = std::make_unique<TextureBoardRenderer>(programs, map);
+      else if (mode == BoardMode::Instanced)
+        renderer = std::make_unique<InstancedBoardRenderer>(programs, map);
+      else
+        renderer = std::make_unique<QuadBoardRenderer>(programs, map, packed);
+      block = std::make_unique<BlockSprite>(programs, map.getWidth(), map.getHeight());
+      const auto&stats = programs.stats();
+      std::cout << std::format("Shader programs: {} from the cache, {} compiled", stats.hits, stats.misses)
+                << std::endl;
+      if (profile) {
+        gpu = std::make_unique<opengl::GpuProfiler<>>();
+        if (!gpu->available())
+          std::cerr << "Warning: no GPU timer queries, the profile has CPU zones only" << std::endl;
       }
-      bgCtx = std::make_unique<OpenGLContext>();
-      blockInfoOffset = board.positions.size();
-      board.addSquare(0, 0, 2.0f / width, 2.0f / height, -0.5f, glm::vec3(1.0f, 0.0f, 0.0f));
-      shader->initAttributeHandles();
-      shader->initUniformHandles();
-      bgCtx->vao.bind();
-      bgCtx->newAttribute("aPos", board.positions, 3, 3 * sizeof(float), GL_FLOAT);
-      bgCtx->newAttribute("aColor", board.colors, 3, 3 * sizeof(float), GL_FLOAT);
-      bgCtx->ebo.bind();
-      bgCtx->ebo.passData(board.idx);
-      shader->use();
     }
-    bool shouldClose(const GameState&state) const {
-      return glfwWindowShouldClose(window) || state.ending != GameEnd::Running;
-    }
-    void updateBlockData(const GameState&state) {
-      auto&vbo = bgCtx->vbo[bgCtx->attribute("aPos")];
-      vbo.bind();
-      board.positions[blockInfoOffset] = glm::vec3(state.displayPos[0], state.displayPos[1], -0.5f);
-      board.positions[blockInfoOffset + 1] = glm::vec3(state.displayPos[0] + 2.0f / width, state.displayPos[1], -0.5f);
-      board.positions[blockInfoOffset + 2] = glm::vec3(state.displayPos[0] + 2.0f / width,
-                                                       state.displayPos[1] + 2.0f / height,
-                                                       -0.5f);
-      board.positions[blockInfoOffset + 3] = glm::vec3(state.displayPos[0], state.displayPos[1] + 2.0f / height, -0.5f);
-      vbo.updateData(board.positions.data() + blockInfoOffset, blockInfoOffset, 4);
-      auto&color_vbo = bgCtx->vbo[bgCtx->attribute("aColor")];
-      color_vbo.bind();
-      glm::vec3 blockColor = glm::vec3(0.0f, 0.0f, 1.0f);
-      if (state.color == TileState::Black)
-        blockColor = glm::vec3(1.0f, 0.0f, 0.0f);
-      board.colors[blockInfoOffset] = blockColor;
-      board.colors[blockInfoOffset + 1] = blockColor;
-      board.colors[blockInfoOffset + 2] = blockColor;
-      board.colors[blockInfoOffset + 3] = blockColor;
-      color_vbo.updateData(board.colors.data() + blockInfoOffset, blockInfoOffset, 4);
-    }
-    void display(const Map&map, const GameState&state) const {
-      glfwPollEvents();
+    bool shouldClose(const core::GameSnapshot&snapshot) const {
+      return glfwWindowShouldClose(window) || snapshot.ending != GameEnd::Running;
+    }
+    void updateBlockData(glm::vec2 displayPos, TileState color) {
+      block->update(displayPos, color);
+    }
+    void display(const Map&map) {
+      // events are polled by the main loop
+      if (gpu)
+        gpu->beginFrame(recordGpuZone);
       int wnd_width, wnd_height;
       glfwGetFramebufferSize(window, &wnd_width, &wnd_height);
       glViewport(0, 0, wnd_width, wnd_height);
       glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
       glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
       glEnable(GL_DEPTH_TEST);
-      OpenGLContext::draw(GL_TRIANGLES, board.idx.size());
-      glfwSwapBuffers(window);
+      {
+        HCI_PROFILE_ZONE("draw");
+        {
+          OGL_GPU_ZONE(gpu.get(), "board");
+          renderer->draw();
+        }
+        OGL_GPU_ZONE(gpu.get(), "block");
+        block->draw();
+      }
+      {
+        HCI_PROFILE_ZONE("swap buffers");
+        glfwSwapBuffers(window);
+      }
+      glState.endFrame();
+    }
+    // waits for the GPU zones still in flight; the number of those read too late to be recorded
+    uint64_t finishProfile() {
+      if (!gpu)
+        return 0;
+      gpu->finish(recordGpuZone);
+      return gpu->dropped();
     }
     ~OglDisplayer() {
+      // GL objects go before the context they live in
+      if (block->stats().waits)
+        std::cout << std::format("Block stream: {} of {} frames waited for the GPU", block->stats().waits,
+                                 block->stats().frames) << std::endl;
+      if (const auto&state = glState; state.frames)
+        std::cout << std::format("GL binds per frame: {:.1f} issued, {:.1f} skipped as redundant",
+                                 static_cast<double>(state.total.issued) / state.frames,
+                                 static_cast<double>(state.total.skipped) / state.frames) << std::endl;
+      gpu.reset();
+      block.reset();
+      renderer.reset();
       glfwDestroyWindow(window);
       glfwTerminate();
     }
 
   private:
+    static void recordGpuZone(const opengl::GpuProfiler<>::Result&zone) {
+      core::Profiler::instance().record("GPU", zone.name, zone.beginNs, zone.endNs);
+    }
+
+    // the window's context's, outlives every GL object of the displayer
+    opengl::GLState glState;
     GLFWwindow* window{};
-    DrawBoard board;
-    int width, height;
-    int blockInfoOffset{};
-    std::unique_ptr<ShaderProg> shader{};
-    std::unique_ptr<OpenGLContext> bgCtx;
+    std::unique_ptr<BoardRenderer> renderer;
+    std::unique_ptr<BlockSprite> block;
+    std::unique_ptr<opengl::GpuProfiler<>> gpu;
 };
 
+// $XDG_CACHE_HOME/hci/shaders or ~/.cache/hci/shaders
+static std::string defaultShaderCache() {
+  if (const char* cache = std::getenv("XDG_CACHE_HOME"); cache && *cache)
+    return std::format("{}/hci/shaders", cache);
+  if (const char* home = std::getenv("HOME"); home && *home)
+    return std::format("{}/.cache/hci/shaders", home);
+  return "";
+}
+
+static void usage() {
+  std::cout << "Usage: game [python script path] [--record log]" << std::endl;
+  std::cout << "       game --pipe [command printing gesture ids] [--record log]" << std::endl;
+  std::cout << "       game --serial [device] [gesture model weights] [--speculate] [--record log]" << std::endl;
+  std::cout << "       game --replay [log] [--speed factor] [--reclassify [gesture model weights]] [--speculate]"
+            << std::endl;
+  std::cout << "       common: [--seed map seed] [--pack level pack [--level index]]"
+            << " [--tick-rate simulation ticks per second]" << std::endl;
+  std::cout << "               [--renderer quads|instanced|texture] [--shader-cache dir | --no-shader-cache]"
+            << std::endl;
+  std::cout << "               [--profile Chrome trace path]" << std::endl;
+}
+
 int main(int argc, char** argv) {
-  if (argc != 2) {
-    std::cout << "Usage: game [python script path]" << std::endl;
+  std::string command, device, replay, record, packPath, profilePath, shaderCache = defaultShaderCache();
+  long levelIndex = -1;
+  BoardMode boardMode = BoardMode::Quads;
+  std::string weights = std::format("{}/hand_classifier_v2.bin", MODEL_DIR);
+  bool speculate = false, reclassify = false;
+  double speed = 1.0, tickRate = 250.0;
+  uint64_t seed = core::MapGenerator::randomSeed();
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool hasValue = i + 1 < argc && argv[i + 1][0] != '-';
+    if (arg == "--serial" && hasValue) {
+      device = argv[++i];
+      if (i + 1 < argc && argv[i + 1][0] != '-')
+        weights = argv[++i];
+    }
+    else if (arg == "--pipe" && i + 1 < argc)
+      command = argv[++i];
+    else if (arg == "--replay" && hasValue)
+      replay = argv[++i];
+    else if (arg == "--record" && hasValue)
+      record = argv[++i];
+    else if (arg == "--speed" && hasValue)
+      speed = std::stod(argv[++i]);
+    else if (arg == "--reclassify") {
+      reclassify = true;
+      if (hasValue)
+        weights = argv[++i];
+    }
+    else if (arg == "--speculate")
+      speculate = true;
+    else if (arg == "--seed" && hasValue)
+      seed = std::stoull(argv[++i]);
+    else if (arg == "--pack" && hasValue)
+      packPath = argv[++i];
+    else if (arg == "--level" && hasValue)
+      levelIndex = std::stol(argv[++i]);
+    else if (arg == "--renderer" && hasValue) {
+      std::string mode = argv[++i];
+      if (mode == "instanced")
+        boardMode = BoardMode::Instanced;
+      else if (mode == "texture")
+        boardMode = BoardMode::Texture;
+      else if (mode != "quads") {
+        usage();
+        return 0;
+      }
+    }
+    else if (arg == "--shader-cache" && hasValue)
+      shaderCache = argv[++i];
+    else if (arg == "--no-shader-cache")
+      shaderCache.clear();
+    else if (arg == "--tick-rate" && hasValue)
+      tickRate = std::stod(argv[++i]);
+    else if (arg == "--profile" && hasValue)
+      profilePath = argv[++i];
+    else if (arg[0] != '-' && command.empty())
+      command = std::format("python {}", arg);
+    else {
+      usage();
+      return 0;
+    }
+  }
+  if (command.empty() + device.empty() + replay.empty() != 2) {
+    usage();
     return 0;
   }
-  std::string pythonScipt = argv[1];
-  auto map = std::make_unique<Map>(1, 30, 50);
-  std::unique_ptr<OglDisplayer> displayer = std::make_unique<OglDisplayer>(*map);
-  std::unique_ptr<PythonSerialAdapter> input = std::make_unique<PythonSerialAdapter>(pythonScipt);
-  GameState state(map->getStart());
-  state.update(*map);
-  displayer->updateBlockData(state);
-  while (!displayer->shouldClose(state)) {
-    glfwPollEvents();
-    if (Action action; input->buffer.TryPop(action))
-      state.move(*map, action);
-    state.update(*map);
-    displayer->updateBlockData(state);
-    displayer->display(*map, state);
+  if (!HCI_PROFILING && !profilePath.empty()) {
+    std::cerr << "Warning: built with HCI_PROFILING=OFF, --profile is ignored" << std::endl;
+    profilePath.clear();
+  }
+  std::unique_ptr<Map> map;
+  core::DistanceField field;
+  core::LevelPackReader pack;
+  core::PackedLevel level;
+  if (!packPath.empty()) {
+    // a packed level is used in place, with its distance field and geometry when they were packed
+    if (!pack.open(packPath) || !pack.size())
+      ERROR("failed to open level pack");
+    size_t index = levelIndex >= 0 ? static_cast<size_t>(levelIndex) : seed % pack.size();
+    if (!pack.level(index, level))
+      ERROR("missing or damaged level");
+    map = std::make_unique<Map>(level.map());
+    if (!field.restore(*map, level.distances))
+      field.build(*map);
+    std::cout << std::format("Level {} of {} (seed {}), shortest solution {} moves", index, pack.size(),
+                             level.seed, field.solutionLength()) << std::endl;
+  }
+  else {
+    // a map nobody can finish is skipped for the next seed
+    map = std::make_unique<Map>(core::MapGenerator(1).generate({1, 30, 50}, seed));
+    field.build(*map);
+    while (!field.solvable()) {
+      *map = core::MapGenerator(1).generate({1, 30, 50}, ++seed);
+      field.build(*map);
+    }
+    // printed so a level worth another try can be replayed with --seed
+    std::cout << std::format("Map seed: {}, shortest solution {} moves", seed, field.solutionLength()) << std::endl;
+  }
+  std::unique_ptr<OglDisplayer> displayer = std::make_unique<OglDisplayer>(*map,
+                                                                           packPath.empty() ? nullptr : &level,
+                                                                           boardMode, shaderCache,
+                                                                           !profilePath.empty());
+  std::unique_ptr<InputAdapter> input;
+  if (!device.empty())
+    input = std::make_unique<NativeGestureAdapter>(device, weights, speculate, record);
+  else if (!replay.empty()) {
+    core::ReplayOptions options;
+    options.speed = speed;
+    options.reclassify = reclassify;
+    options.weights = weights;
+    options.detector.threshold = kScoreThreshold;
+    options.detector.speculate = speculate;
+    auto replayer = std::make_unique<core::ReplayAdapter>(options);
+    if (!replayer->open(replay))
+      ERROR("failed to open session log");
+    replayer->start();
+    input = std::move(replayer);
+  }
+  else
+    input = std::make_unique<PythonSerialAdapter>(command, record);
+  GlfwClock clock;
+  core::LatencyTrace trace;
+  core::LatencyTrace::installSignalHandler(SIGUSR1);
+  core::GameSimulation simulation(*map, input->buffer, clock, {tickRate}, &trace);
+  auto& profiler = core::Profiler::instance();
+  if (!profilePath.empty()) {
+    profiler.start();
+    HCI_PROFILE_THREAD("render");
+  }
+  simulation.start();
+  const core::GameSnapshot* snapshot = &simulation.latest();
+  // the simulation may publish a capture once more after the frame showing it was acquired
+  int64_t tracedCaptureNs = 0;
+  while (!displayer->shouldClose(*snapshot)) {
+    HCI_PROFILE_ZONE("frame");
+    {
+      HCI_PROFILE_ZONE("poll events");
+      glfwPollEvents();
+    }
+    // the newest tick is drawn as soon as the frame is ready, actions are traced from their capture until the
+    // first frame showing them is swapped
+    bool fresh;
+    snapshot = &simulation.latest(&fresh);
+    {
+      HCI_PROFILE_ZONE("update block");
+      displayer->updateBlockData(snapshot->displayPos(*map, clock.now()), snapshot->color);
+    }
+    int64_t uploadedNs = core::monotonicNs();
+    displayer->display(*map);
+    if (fresh && snapshot->captureNs && snapshot->captureNs != tracedCaptureNs) {
+      tracedCaptureNs = snapshot->captureNs;
+      int64_t presentedNs = core::monotonicNs();
+      trace.record(core::TraceStage::Upload, snapshot->publishedNs, uploadedNs);
+      trace.record(core::TraceStage::Present, uploadedNs, presentedNs);
+      trace.record(core::TraceStage::Total, snapshot->captureNs, presentedNs);
+    }
+    if (core::LatencyTrace::signalled())
+      trace.summary(std::cerr);
+    // the rings of both threads are emptied once a frame
+    if (profiler.enabled())
+      profiler.collect();
+  }
+  simulation.stop();
+  if (profiler.enabled()) {
+    uint64_t gpuDropped = displayer->finishProfile();
+    profiler.stop();
+    if (profiler.writeChromeTrace(profilePath))
+      std::cout << std::format("Profile: {} zones written to {}, {} dropped", profiler.zoneCount(), profilePath,
+                               profiler.dropped() + gpuDropped) << std::endl;
   }
   std::cout << "Game ended!" << std::endl;
+  auto stats = simulation.stats();
+  std::cout << std::format("{} ticks, {} actions, at most {} in one tick, {} stalls", stats.ticks, stats.actions,
+                           stats.maxActionsPerTick, stats.lateTicks) << std::endl;
+  trace.summary(std::cout);
+  if (input->buffer.droppedCount())
+    std::cerr << std::format("Warning: input buffer overflowed, {} of {} actions dropped",
+                             input->buffer.droppedCount(),
+                             input->buffer.pushedCount() + input->buffer.droppedCount()) << std::endl;
 }
@@ -0,0 +1,262 @@
+#include <core/gesture-model.h>
+#include <core/gesture-service.h>
+#include <core/gesture-speculation.h>
+#include <core/keypoint-window.h>
+#include <core/timing.h>
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+static double percentile(std::vector<int64_t>& values, double q) {
+  if (values.empty())
+    return 0.0;
+  std::sort(values.begin(), values.end());
+  return static_cast<double>(values[static_cast<size_t>(q * (values.size() - 1))]);
+}
+
+// per-window cost of predictBatch at growing batch sizes, checked bit for bit against predict
+static int benchBatches(core::GestureModel& model, std::mt19937& gen, int maxBatch) {
+  std::uniform_real_distribution<float> distrib(0.f, 1.f);
+  std::vector<std::vector<float>> windows(maxBatch, std::vector<float>(model.windowSize()));
+  std::vector<const float*> ptrs;
+  for (auto& w : windows) {
+    for (auto& v : w)
+      v = distrib(gen);
+    ptrs.push_back(w.data());
+  }
+  model.reserveBatch(maxBatch);
+  std::vector<float> batched(maxBatch * model.numClasses()), single(model.numClasses());
+  int mismatches = 0;
+  double baseline = 0.0;
+  for (int batch = 1; batch <= maxBatch; batch *= 2) {
+    int rounds = std::max(1, 2000 / batch);
+    int64_t begin = core::monotonicNs();
+    for (int r = 0; r < rounds; r++)
+      model.predictBatch(ptrs.data(), batch, batched.data());
+    double perWindow = static_cast<double>(core::monotonicNs() - begin) / rounds / batch;
+    if (batch == 1)
+      baseline = perWindow;
+    for (int b = 0; b < batch; b++) {
+      model.predict(ptrs[b], single.data());
+      if (memcmp(single.data(), batched.data() + b * model.numClasses(), single.size() * sizeof(float)) != 0)
+        mismatches++;
+    }
+    std::cout << std::format("batch {:3}: {:.1f} us/window, {:.2f}x throughput of batch 1", batch, perWindow / 1e3,
+                             baseline / perWindow) << std::endl;
+  }
+  std::cout << std::format("{} windows differ from single evaluation", mismatches) << std::endl;
+  return mismatches == 0 ? 0 : 1;
+}
+
+// streams producing windows at a fixed rate into a GestureService, reporting submit to result latency
+static int benchService(core::GestureModel& model, int numStreams, int maxBatch, double fps) {
+  core::GestureService service(model, {maxBatch, 2'000'000, 0.95f});
+  std::vector<std::unique_ptr<core::ActionQueue>> queues;
+  for (int i = 0; i < numStreams; i++) {
+    queues.push_back(std::make_unique<core::ActionQueue>());
+    service.addStream(*queues.back());
+  }
+  std::mutex mtx;
+  std::vector<int64_t> latencies;
+  service.onResult([&](int, int, float, int64_t, int64_t submitNs) {
+    std::lock_guard<std::mutex> lk(mtx);
+    latencies.push_back(core::monotonicNs() - submitNs);
+  });
+  service.start();
+  int64_t period = static_cast<int64_t>(1e9 / fps);
+  int64_t runFor = 2'000'000'000;
+  std::vector<std::thread> producers;
+  for (int i = 0; i < numStreams; i++) {
+    producers.emplace_back([&, i]() {
+      std::mt19937 gen(i);
+      std::uniform_real_distribution<float> distrib(0.f, 1.f);
+      core::GestureService::Window window;
+      int64_t start = core::monotonicNs(), next = start;
+      while (next - start < runFor) {
+        for (auto& v : window)
+          v = distrib(gen);
+        service.submit(i, window, core::monotonicNs());
+        next += period;
+        std::this_thread::sleep_for(std::chrono::nanoseconds(next - core::monotonicNs()));
+      }
+    });
+  }
+  for (auto& t : producers)
+    t.join();
+  service.stop();
+  auto stats = service.stats();
+  std::cout << std::format("{} streams at {:.0f} fps: {} windows in {} batches (mean {:.1f}), {} dropped",
+                           numStreams, fps, stats.windows, stats.batches,
+                           stats.batches ? static_cast<double>(stats.windows) / stats.batches : 0.0,
+                           stats.dropped) << std::endl;
+  std::cout << std::format("latency p50 {:.1f} us, p99 {:.1f} us, max {:.1f} us", percentile(latencies, 0.5) / 1e3,
+                           percentile(latencies, 0.99) / 1e3, stats.maxLatencyNs / 1e3) << std::endl;
+  return 0;
+}
+
+// replay a recorded stream (raw device output, e.g. cat /dev/ttyUSB0 > capture.txt) through the speculative
+// detector at several settings and report how much earlier gestures arrive against how often they are wrong
+static int benchSpeculation(core::GestureModel& model, const std::string& capture, double fps) {
+  std::ifstream in(capture, std::ios::binary);
+  if (!in) {
+    std::cerr << std::format("Failed to open capture {}", capture) << std::endl;
+    return 1;
+  }
+  std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  std::vector<core::KeypointFrame> frames;
+  core::KeypointParser parser;
+  parser.parse(text.data(), text.size(), [&](const core::KeypointFrame& frame) { frames.push_back(frame); });
+  std::cout << std::format("{}: {} frames, {} malformed", capture, frames.size(), parser.malformedCount())
+            << std::endl;
+  std::cout << "steps  early  provisional  confirmed  retracted  false positive  saved frames  saved ms  "
+               "full only" << std::endl;
+  core::GestureEvent events[core::SpeculativeGestureDetector::kMaxEvents];
+  for (int steps : {8, 12, 16}) {
+    for (float early : {0.95f, 0.98f, 0.99f, 0.995f, 0.999f}) {
+      core::SpeculativeGestureDetector::Config config;
+      config.earlySteps = steps;
+      config.minSteps = std::min(config.minSteps, steps);
+      config.earlyThreshold = early;
+      core::SpeculativeGestureDetector detector(model, config);
+      core::KeypointWindow<> window;
+      for (const auto& frame : frames) {
+        window.push(frame);
+        detector.push(window.newest().data(), events);
+      }
+      const auto& stats = detector.stats();
+      double saved = stats.confirmed ? static_cast<double>(stats.framesSaved) / stats.confirmed : 0.0;
+      // final gestures are the ones speculation did not anticipate
+      std::cout << std::format("{:5}  {:5.3f}  {:11}  {:9}  {:9}  {:13.1f}%  {:12.1f}  {:8.1f}  {:9}", steps, early,
+                               stats.provisional, stats.confirmed, stats.retracted,
+                               stats.provisional ? 100.0 * stats.retracted / stats.provisional : 0.0, saved,
+                               saved * 1e3 / fps, stats.finals) << std::endl;
+    }
+  }
+  return 0;
+}
+
+// validate and benchmark the native gesture classifier
+int main(int argc, char** argv) {
+  std::string weights = std::format("{}/hand_classifier_v2.bin", MODEL_DIR);
+  std::string reference, capture;
+  float tolerance = 1e-4f;
+  int iterations = 10000;
+  int streamFrames = 0;
+  int maxBatch = 0;
+  int serviceStreams = 0;
+  double fps = 120.0;
+  bool scalar = false;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--validate") && i + 1 < argc)
+      reference = argv[++i];
+    else if (!strcmp(argv[i], "--tolerance") && i + 1 < argc)
+      tolerance = std::stof(argv[++i]);
+    else if (!strcmp(argv[i], "--bench") && i + 1 < argc)
+      iterations = std::stoi(argv[++i]);
+    else if (!strcmp(argv[i], "--stream") && i + 1 < argc)
+      streamFrames = std::stoi(argv[++i]);
+    else if (!strcmp(argv[i], "--batch") && i + 1 < argc)
+      maxBatch = std::stoi(argv[++i]);
+    else if (!strcmp(argv[i], "--service") && i + 1 < argc)
+      serviceStreams = std::stoi(argv[++i]);
+    else if (!strcmp(argv[i], "--speculate") && i + 1 < argc)
+      capture = argv[++i];
+    else if (!strcmp(argv[i], "--fps") && i + 1 < argc)
+      fps = std::stod(argv[++i]);
+    else if (!strcmp(argv[i], "--scalar"))
+      scalar = true;
+    else if (argv[i][0] != '-')
+      weights = argv[i];
+    else {
+      std::cout << "Usage: gesture-infer [weights path] [--validate reference] [--tolerance t] "
+                   "[--bench iterations] [--stream frames] [--batch max batch] "
+                   "[--service streams [--fps rate]] [--speculate capture [--fps rate]] [--scalar]" << std::endl;
+      return 0;
+    }
+  }
+  core::GestureModel model;
+  if (!model.load(weights))
+    return 1;
+  if (scalar)
+    model.setKernel(core::GestureModel::Kernel::Scalar);
+  if (!reference.empty())
+    return model.validate(reference, tolerance) ? 0 : 1;
+  if (!capture.empty())
+    return benchSpeculation(model, capture, fps);
+
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<float> distrib(0.f, 1.f);
+  if (serviceStreams > 0)
+    return benchService(model, serviceStreams, maxBatch > 0 ? maxBatch : 16, fps);
+  if (maxBatch > 0)
+    return benchBatches(model, gen, maxBatch);
+  if (streamFrames > 0) {
+    // slide a window over random frames, checking the incremental result against full evaluation
+    if (model.inputDim() != core::kKeypointDim || model.timeSteps() != core::kWindowFrames) {
+      std::cerr << "Model does not take 23 keypoint frames" << std::endl;
+      return 1;
+    }
+    std::vector<core::KeypointFrame> frames(streamFrames + core::kWindowFrames);
+    for (auto& frame : frames)
+      for (auto& v : frame)
+        v = distrib(gen);
+    core::KeypointWindow<> window;
+    core::GestureStream stream(model);
+    std::vector<float> incremental(model.numClasses()), full(model.numClasses());
+    int64_t windowNs = 0, streamNs = 0, fullNs = 0;
+    int compared = 0, mismatches = 0;
+    for (const auto& frame : frames) {
+      int64_t begin = core::monotonicNs();
+      window.push(frame);
+      windowNs += core::monotonicNs() - begin;
+      begin = core::monotonicNs();
+      bool ready = stream.push(window.newest().data(), incremental.data());
+      streamNs += core::monotonicNs() - begin;
+      if (!ready)
+        continue;
+      begin = core::monotonicNs();
+      model.predict(window.data(), full.data());
+      fullNs += core::monotonicNs() - begin;
+      compared++;
+      if (memcmp(incremental.data(), full.data(), full.size() * sizeof(float)) != 0)
+        mismatches++;
+    }
+    std::cout << std::format("{} windows: preprocessing {:.0f} ns/frame, incremental {:.1f} us/frame, "
+                             "full {:.1f} us/window, {} bit mismatches", compared,
+                             static_cast<double>(windowNs) / frames.size(), streamNs / 1e3 / compared,
+                             fullNs / 1e3 / compared, mismatches) << std::endl;
+    std::cout << std::format("{} of {} flops saved per frame ({:.1f}%), {} in total",
+                             stream.flopsSavedPerFrame(), model.flopsPerWindow(),
+                             100.0 * stream.flopsSavedPerFrame() / model.flopsPerWindow(),
+                             stream.flopsSaved()) << std::endl;
+    return mismatches == 0 ? 0 : 1;
+  }
+  if (iterations <= 0)
+    return 0;
+  std::vector<float> window(model.windowSize());
+  for (auto& v : window)
+    v = distrib(gen);
+  std::vector<float> probabilities(model.numClasses());
+  std::vector<int64_t> latencies(iterations);
+  for (int i = 0; i < iterations; i++) {
+    int64_t begin = core::monotonicNs();
+    model.predict(window.data(), probabilities.data());
+    latencies[i] = core::monotonicNs() - begin;
+  }
+  std::sort(latencies.begin(), latencies.end());
+  int64_t total = 0;
+  for (auto ns : latencies)
+    total += ns;
+  std::cout << std::format("{} kernel, {} windows: mean {:.1f} us, p50 {:.1f} us, p99 {:.1f} us",
+                           model.kernel() == core::GestureModel::Kernel::Avx2 ? "avx2" : "scalar", iterations,
+                           total / 1e3 / iterations, latencies[iterations / 2] / 1e3,
+                           latencies[iterations * 99 / 100] / 1e3) << std::endl;
+}
@@ -0,0 +1,304 @@
+#include <core/serial-reader.h>
+#include <core/timing.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <format>
+#include <iostream>
+#include <poll.h>
+#include <random>
+#include <string>
+#include <termios.h>
+#include <thread>
+#include <unistd.h>
+
+// synthetic load for the input pipeline, standing in for either end of it:
+//   gestures   gesture ids on stdout as hand_side.py prints them: one id per line (998 for no gesture), with
+//              whatever comes before a line "#" skipped by the reader
+//   keypoints  device frames on a pseudo-terminal (or stdout), for game --serial and gesture-infer
+struct Options {
+  bool keypoints = false;
+  double rate = 1.0;
+  // events per burst and pause between bursts, no bursts by default
+  int64_t burst = 0;
+  double idleMs = 0.0;
+  int64_t count = -1;
+  double duration = -1.0;
+  uint32_t seed = 1;
+  // gestures: ids repeat for a run of runMin..runMax lines like a held gesture
+  int runMin = 1, runMax = 10;
+  double invalid = 1.0 / 6.0;
+  // gestures: chance a line inside a run is replaced by a random id; keypoints: jitter in pixels
+  double noise = 0.0;
+  // keypoints: chance of a garbled frame and of a frame without a hand (all zeros)
+  double malformed = 0.0;
+  double dropout = 0.0;
+  bool toStdout = false;
+  int prelude = 3;
+};
+
+// paces events at rate, in bursts when asked; sleeps only when ahead of schedule by more than a
+// millisecond so rates of tens of kHz are met on average
+class Pacer {
+  public:
+    explicit Pacer(const Options& options)
+      : period(static_cast<int64_t>(1e9 / options.rate)), burst(options.burst),
+        idle(static_cast<int64_t>(options.idleMs * 1e6)), next(core::monotonicNs()) {
+    }
+    // returns true when the caller should flush, i.e. before a pause
+    bool wait() {
+      next += period;
+      if (burst > 0 && ++inBurst == burst) {
+        inBurst = 0;
+        next += idle;
+      }
+      return next - core::monotonicNs() > 1'000'000;
+    }
+    void sleep() const {
+      std::this_thread::sleep_for(std::chrono::nanoseconds(next - core::monotonicNs()));
+    }
+
+  private:
+    int64_t period, burst, idle, next;
+    int64_t inBurst{};
+};
+
+static bool writeAll(int fd, const char* data, size_t len) {
+  while (len > 0) {
+    ssize_t n = write(fd, data, len);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      return false;
+    data += n;
+    len -= n;
+  }
+  return true;
+}
+
+static bool finishedAt(const Options& options, int64_t events, int64_t begin) {
+  if (options.count >= 0 && events >= options.count)
+    return true;
+  return options.duration >= 0 && static_cast<double>(core::monotonicNs() - begin) / 1e9 >= options.duration;
+}
+
+static void report(const char* what, int64_t events, int64_t begin) {
+  double seconds = static_cast<double>(core::monotonicNs() - begin) / 1e9;
+  std::cerr << std::format("input-gen: {} {} in {:.2f} s, {:.0f}/s", events, what, seconds,
+                           seconds > 0 ? events / seconds : 0.0) << std::endl;
+}
+
+static int generateGestures(const Options& options) {
+  std::mt19937 gen(options.seed);
+  std::uniform_real_distribution<double> chance(0.0, 1.0);
+  std::uniform_int_distribution<int> gesture(0, 4);
+  std::uniform_int_distribution<int> runLength(options.runMin, options.runMax);
+  auto pick = [&]() { return chance(gen) < options.invalid ? 998 : gesture(gen); };
+  std::string out;
+  // the reader skips everything up to the '#' that hand_side.py prints once it is ready
+  for (int i = 0; i < options.prelude; i++)
+    out += std::format("{}\n", pick());
+  out += "#\n";
+  Pacer pacer(options);
+  int64_t events = 0, begin = core::monotonicNs();
+  int current = pick(), left = runLength(gen);
+  while (!finishedAt(options, events, begin)) {
+    if (left-- == 0) {
+      current = pick();
+      left = runLength(gen) - 1;
+    }
+    int id = options.noise > 0.0 && chance(gen) < options.noise ? pick() : current;
+    out += std::format("{}\n", id);
+    events++;
+    if (pacer.wait() || out.size() > 4096) {
+      if (!writeAll(STDOUT_FILENO, out.data(), out.size()))
+        break;
+      out.clear();
+      pacer.sleep();
+    }
+  }
+  writeAll(STDOUT_FILENO, out.data(), out.size());
+  report("gesture ids", events, begin);
+  return 0;
+}
+
+// a hand drifting around a 640 x 480 image, alternately holding still and moving in one direction
+class HandMotion {
+  public:
+    explicit HandMotion(std::mt19937& gen) : gen(gen) {
+      // wrist first, then the fingers fanning out upwards
+      shape[0] = shape[1] = 0.f;
+      for (int k = 1; k < 21; k++) {
+        int finger = (k - 1) / 4, joint = (k - 1) % 4;
+        float angle = 2.4f - 0.3f * finger;
+        float radius = 40.f + 30.f * joint + (finger == 0 ? 0.f : 20.f);
+        shape[2 * k] = std::cos(angle) * radius;
+        shape[2 * k + 1] = -std::sin(angle) * radius;
+      }
+    }
+    void step(core::KeypointFrame& frame, double jitter) {
+      if (--segment <= 0) {
+        static constexpr float kDirections[5][2] = {{0, 0}, {-8, 0}, {8, 0}, {0, -8}, {0, 8}};
+        moving = !moving;
+        int d = moving ? std::uniform_int_distribution<int>(1, 4)(gen) : 0;
+        dx = kDirections[d][0];
+        dy = kDirections[d][1];
+        segment = std::uniform_int_distribution<int>(15, 45)(gen);
+      }
+      std::normal_distribution<float> noise(0.f, static_cast<float>(std::max(jitter, 1e-3)));
+      cx = std::clamp(cx + dx + noise(gen), 60.f, 580.f);
+      cy = std::clamp(cy + dy + noise(gen), 100.f, 440.f);
+      for (int i = 0; i < core::kKeypointDim; i += 2) {
+        frame[i] = cx + shape[i] + noise(gen);
+        frame[i + 1] = cy + shape[i + 1] + noise(gen);
+      }
+    }
+
+  private:
+    std::mt19937& gen;
+    core::KeypointFrame shape{};
+    float cx{320.f}, cy{300.f}, dx{}, dy{};
+    int segment{};
+    bool moving{true};
+};
+
+// block until something opens the slave side, so frames are not generated into the void
+static bool waitForReader(int master) {
+  for (;;) {
+    pollfd pfd{master, POLLOUT, 0};
+    if (poll(&pfd, 1, 100) < 0 && errno != EINTR)
+      return false;
+    if (!(pfd.revents & POLLHUP))
+      return true;
+  }
+}
+
+static int generateKeypoints(const Options& options) {
+  int fd = STDOUT_FILENO;
+  int master = -1;
+  if (!options.toStdout) {
+    std::string slave;
+    master = core::openPseudoTerminal(slave);
+    if (master < 0)
+      return 1;
+    // raw mode so the line discipline neither echoes frames back nor rewrites them
+    int s = open(slave.c_str(), O_RDWR | O_NOCTTY);
+    termios tio{};
+    if (s < 0 || tcgetattr(s, &tio) != 0) {
+      std::cerr << std::format("Failed to configure {}: {}", slave, strerror(errno)) << std::endl;
+      return 1;
+    }
+    cfmakeraw(&tio);
+    tcsetattr(s, TCSANOW, &tio);
+    close(s);
+    std::cerr << std::format("input-gen: keypoint frames on {}", slave) << std::endl;
+    if (!waitForReader(master))
+      return 1;
+    fd = master;
+  }
+  std::mt19937 gen(options.seed);
+  std::uniform_real_distribution<double> chance(0.0, 1.0);
+  HandMotion hand(gen);
+  core::KeypointFrame frame{};
+  Pacer pacer(options);
+  std::string out;
+  int64_t events = 0, begin = core::monotonicNs();
+  while (!finishedAt(options, events, begin)) {
+    hand.step(frame, options.noise);
+    if (options.dropout > 0.0 && chance(gen) < options.dropout)
+      frame.fill(0.f);
+    out += '[';
+    for (int i = 0; i < core::kKeypointDim; i++) {
+      if (i)
+        out += ',';
+      out += std::format("{:.2f}", frame[i]);
+    }
+    out += "]\n";
+    // a garbled frame: a value cut off by a dropped byte
+    if (options.malformed > 0.0 && chance(gen) < options.malformed)
+      out.erase(out.size() - 10, 3);
+    events++;
+    if (pacer.wait() || out.size() > 4096) {
+      if (!writeAll(fd, out.data(), out.size()))
+        break;
+      out.clear();
+      pacer.sleep();
+    }
+  }
+  writeAll(fd, out.data(), out.size());
+  report("keypoint frames", events, begin);
+  if (master >= 0) {
+    // give the reader a moment to drain before the pty goes away
+    tcdrain(master);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    close(master);
+  }
+  return 0;
+}
+
+static void usage() {
+  std::cout << "Usage: input-gen gestures [--rate hz] [--run min max] [--invalid p] [--noise p] [--prelude n]"
+            << std::endl;
+  std::cout << "       input-gen keypoints [--stdout] [--rate hz] [--noise px] [--malformed p] [--dropout p]"
+            << std::endl;
+  std::cout << "       common: [--burst events --idle ms] [--count n] [--duration s] [--seed s]" << std::endl;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2 || (strcmp(argv[1], "gestures") != 0 && strcmp(argv[1], "keypoints") != 0)) {
+    usage();
+    return 0;
+  }
+  Options options;
+  options.keypoints = !strcmp(argv[1], "keypoints");
+  // one gesture id a second by default, a camera's pace for frames
+  options.rate = options.keypoints ? 30.0 : 1.0;
+  if (options.keypoints) {
+    options.noise = 1.5;
+    options.invalid = 0.0;
+  }
+  for (int i = 2; i < argc; i++) {
+    bool hasValue = i + 1 < argc;
+    if (!strcmp(argv[i], "--rate") && hasValue)
+      options.rate = std::stod(argv[++i]);
+    else if (!strcmp(argv[i], "--burst") && hasValue)
+      options.burst = std::stoll(argv[++i]);
+    else if (!strcmp(argv[i], "--idle") && hasValue)
+      options.idleMs = std::stod(argv[++i]);
+    else if (!strcmp(argv[i], "--count") && hasValue)
+      options.count = std::stoll(argv[++i]);
+    else if (!strcmp(argv[i], "--duration") && hasValue)
+      options.duration = std::stod(argv[++i]);
+    else if (!strcmp(argv[i], "--seed") && hasValue)
+      options.seed = static_cast<uint32_t>(std::stoul(argv[++i]));
+    else if (!strcmp(argv[i], "--run") && i + 2 < argc) {
+      options.runMin = std::max(1, std::stoi(argv[++i]));
+      options.runMax = std::max(options.runMin, std::stoi(argv[++i]));
+    }
+    else if (!strcmp(argv[i], "--invalid") && hasValue)
+      options.invalid = std::stod(argv[++i]);
+    else if (!strcmp(argv[i], "--noise") && hasValue)
+      options.noise = std::stod(argv[++i]);
+    else if (!strcmp(argv[i], "--malformed") && hasValue)
+      options.malformed = std::stod(argv[++i]);
+    else if (!strcmp(argv[i], "--dropout") && hasValue)
+      options.dropout = std::stod(argv[++i]);
+    else if (!strcmp(argv[i], "--prelude") && hasValue)
+      options.prelude = std::stoi(argv[++i]);
+    else if (!strcmp(argv[i], "--stdout"))
+      options.toStdout = true;
+    else {
+      usage();
+      return 0;
+    }
+  }
+  if (options.rate <= 0.0) {
+    std::cerr << "Rate must be positive" << std::endl;
+    return 1;
+  }
+  return options.keypoints ? generateKeypoints(options) : generateGestures(options);
+}
@@ -0,0 +1,153 @@
+#include <core/distance-field.h>
+#include <core/level-pack.h>
+#include <core/map-generator.h>
+#include <core/timing.h>
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// builds level packs offline (core/level-pack.h) from generated maps, and inspects them
+struct Options {
+  std::string out, info;
+  int levels = 10000;
+  core::MapSpec spec;
+  uint64_t seed = 1;
+  int threads = 0;
+  core::LevelPackWriter::Options pack;
+  bool keepUnsolvable = false;
+  long level = -1;
+};
+
+static void usage() {
+  std::cout << "Usage: level-pack --out file [--levels n] [--paths n] [--length min max] [--seed first seed]"
+            << std::endl;
+  std::cout << "                  [--threads n] [--no-distances] [--no-vertices] [--keep-unsolvable]" << std::endl;
+  std::cout << "       level-pack --info file [--level i]" << std::endl;
+}
+
+static int pack(const Options& options) {
+  core::LevelPackWriter writer;
+  if (!writer.open(options.out, options.pack))
+    return 1;
+  int64_t begin = core::monotonicNs();
+  core::MapGenerator generator(options.threads);
+  core::DistanceField field;
+  constexpr int kBatch = 1024;
+  uint64_t seed = options.seed;
+  size_t skipped = 0;
+  while (writer.levelCount() < static_cast<size_t>(options.levels)) {
+    int count = std::min<int>(kBatch, options.levels - static_cast<int>(writer.levelCount()));
+    std::vector<core::Map> maps = generator.generateBatch(options.spec, seed, count);
+    for (const auto& map : maps) {
+      field.build(map);
+      // an unsolvable seed is left out, levels keep the seed they were generated from
+      if (field.solvable() || options.keepUnsolvable) {
+        if (!writer.add(map, seed, &field))
+          return 1;
+      }
+      else
+        skipped++;
+      seed++;
+    }
+  }
+  if (!writer.close())
+    return 1;
+  std::cout << std::format("{} levels packed into {} in {:.1f} ms, {} unsolvable seeds skipped",
+                           writer.levelCount(), options.out, (core::monotonicNs() - begin) / 1e6, skipped)
+            << std::endl;
+  return 0;
+}
+
+static int info(const Options& options) {
+  int64_t begin = core::monotonicNs();
+  core::LevelPackReader reader;
+  if (!reader.open(options.info))
+    return 1;
+  int64_t opened = core::monotonicNs();
+  if (!reader.size()) {
+    std::cout << "empty pack" << std::endl;
+    return 0;
+  }
+  size_t i = options.level >= 0 ? static_cast<size_t>(options.level) : reader.size() / 2;
+  core::PackedLevel level;
+  if (!reader.level(i, level)) {
+    std::cerr << std::format("Level {} is missing or damaged", i) << std::endl;
+    return 1;
+  }
+  core::Map map = level.map();
+  int64_t loaded = core::monotonicNs();
+  core::DistanceField field;
+  bool restored = !level.distances.empty() && field.restore(map, level.distances);
+  int64_t restoredNs = core::monotonicNs();
+
+  std::cout << std::format("{}: {} levels, {} bytes", options.info, reader.size(), reader.sizeBytes()) << std::endl;
+  std::cout << std::format("opened in {:.1f} us, level {} read in {:.1f} us", (opened - begin) / 1e3, i,
+                           (loaded - opened) / 1e3) << std::endl;
+  std::cout << std::format("level {}: seed {}, {} x {}, {} exits, {} vertices", i, level.seed, level.width,
+                           level.height, level.exits.size(), level.positions.size()) << std::endl;
+  if (restored)
+    std::cout << std::format("distance field restored in {:.1f} us, shortest solution {} moves",
+                             (restoredNs - loaded) / 1e3, field.solutionLength()) << std::endl;
+  map.getMapInfo();
+
+  // every level is checked and compared against a fresh search
+  size_t damaged = 0, mismatched = 0;
+  for (size_t j = 0; j < reader.size(); j++) {
+    core::PackedLevel other;
+    if (!reader.level(j, other)) {
+      damaged++;
+      continue;
+    }
+    if (!other.distances.empty()) {
+      core::Map otherMap = other.map();
+      field.build(otherMap);
+      if (field.solutionLength() != other.solutionLength)
+        mismatched++;
+    }
+  }
+  std::cout << std::format("{} damaged levels, {} with a stale distance field", damaged, mismatched) << std::endl;
+  return damaged || mismatched;
+}
+
+int main(int argc, char** argv) {
+  Options options;
+  for (int i = 1; i < argc; i++) {
+    bool hasValue = i + 1 < argc;
+    if (!strcmp(argv[i], "--out") && hasValue)
+      options.out = argv[++i];
+    else if (!strcmp(argv[i], "--info") && hasValue)
+      options.info = argv[++i];
+    else if (!strcmp(argv[i], "--level") && hasValue)
+      options.level = std::stol(argv[++i]);
+    else if (!strcmp(argv[i], "--levels") && hasValue)
+      options.levels = std::max(1, std::stoi(argv[++i]));
+    else if (!strcmp(argv[i], "--paths") && hasValue)
+      options.spec.numPaths = std::max(1, std::stoi(argv[++i]));
+    else if (!strcmp(argv[i], "--length") && i + 2 < argc) {
+      options.spec.minPathLen = std::max(1, std::stoi(argv[++i]));
+      options.spec.maxPathLen = std::max(options.spec.minPathLen + 1, std::stoi(argv[++i]));
+    }
+    else if (!strcmp(argv[i], "--seed") && hasValue)
+      options.seed = std::stoull(argv[++i]);
+    else if (!strcmp(argv[i], "--threads") && hasValue)
+      options.threads = std::stoi(argv[++i]);
+    else if (!strcmp(argv[i], "--no-distances"))
+      options.pack.distances = false;
+    else if (!strcmp(argv[i], "--no-vertices"))
+      options.pack.vertices = false;
+    else if (!strcmp(argv[i], "--keep-unsolvable"))
+      options.keepUnsolvable = true;
+    else {
+      usage();
+      return 0;
+    }
+  }
+  if (options.out.empty() == options.info.empty()) {
+    usage();
+    return 0;
+  }
+  return options.out.empty() ? info(options) : pack(options);
+}
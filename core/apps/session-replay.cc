@@ -0,0 +1,138 @@
+#include <core/gesture-pipeline.h>
+#include <core/session-log.h>
+#include <core/timing.h>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// turn a raw device capture (cat /dev/ttyUSB0 > capture.txt) into a session log, stamping frames at fps
+// and recording what the classifier makes of them as the reference for later replays
+static int importCapture(core::GestureModel& model, const core::SpeculativeGestureDetector::Config& config,
+                         const std::string& capture, const std::string& path, double fps) {
+  std::ifstream in(capture, std::ios::binary);
+  if (!in) {
+    std::cerr << std::format("Failed to open capture {}", capture) << std::endl;
+    return 1;
+  }
+  std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  core::SessionLogWriter log;
+  if (!log.open(path))
+    return 1;
+  core::GesturePipeline pipeline(model, config);
+  core::ActionQueue actions;
+  core::KeypointParser parser;
+  int64_t frames = 0, period = static_cast<int64_t>(1e9 / fps);
+  parser.parse(text.data(), text.size(), [&](const core::KeypointFrame& frame) {
+    pipeline.push(frame, frames++ * period, actions, &log);
+    for (core::TimedEvent<core::ActionEvent> event; actions.tryPop(event);) {
+    }
+  });
+  if (!log.flush())
+    return 1;
+  std::cout << std::format("{}: {} frames ({} malformed), {} records", path, frames, parser.malformedCount(),
+                           log.recordCount()) << std::endl;
+  return 0;
+}
+
+// run every keypoint frame of the log through the classifier again, as fast as possible, and check the
+// actions against the ones recorded with it
+static int replayLog(core::GestureModel& model, const core::SpeculativeGestureDetector::Config& config,
+                     const std::string& path, int repeat) {
+  core::SessionLogReader reader;
+  if (!reader.open(path))
+    return 1;
+  std::vector<core::ActionEvent> recorded;
+  int64_t firstNs = 0, lastNs = 0;
+  uint64_t frames = 0;
+  core::LogRecord record{};
+  while (reader.next(record)) {
+    if (record.type == core::LogRecordType::Action)
+      recorded.push_back(record.action);
+    if (record.type != core::LogRecordType::Keypoints)
+      continue;
+    if (frames++ == 0)
+      firstNs = record.timeNs;
+    lastNs = record.timeNs;
+  }
+  if (reader.truncated())
+    std::cerr << "Warning: session log ends in the middle of a record" << std::endl;
+
+  std::vector<core::ActionEvent> replayed;
+  int64_t elapsed = 0;
+  for (int pass = 0; pass < repeat; pass++) {
+    core::GesturePipeline pipeline(model, config);
+    core::ActionQueue actions;
+    replayed.clear();
+    reader.rewind();
+    int64_t begin = core::monotonicNs();
+    while (reader.next(record)) {
+      if (record.type != core::LogRecordType::Keypoints)
+        continue;
+      core::KeypointFrame frame;
+      memcpy(frame.data(), record.keypoints, sizeof(frame));
+      pipeline.push(frame, record.timeNs, actions);
+      for (core::TimedEvent<core::ActionEvent> event; actions.tryPop(event);)
+        replayed.push_back(event.value);
+    }
+    elapsed += core::monotonicNs() - begin;
+  }
+
+  size_t mismatches = recorded.size() > replayed.size() ? recorded.size() - replayed.size()
+                                                        : replayed.size() - recorded.size();
+  for (size_t i = 0; i < std::min(recorded.size(), replayed.size()); i++) {
+    if (recorded[i].action != replayed[i].action || recorded[i].status != replayed[i].status)
+      mismatches++;
+  }
+  double seconds = static_cast<double>(elapsed) / repeat / 1e9;
+  double span = static_cast<double>(lastNs - firstNs) / 1e9;
+  std::cout << std::format("{} frames, {:.1f} s recorded, replayed in {:.3f} s ({:.0f} frames/s, {:.0f}x real time)",
+                           frames, span, seconds, frames / seconds, seconds > 0 ? span / seconds : 0.0)
+            << std::endl;
+  std::cout << std::format("{} recorded actions, {} replayed, {} mismatches", recorded.size(), replayed.size(),
+                           mismatches) << std::endl;
+  return mismatches == 0 ? 0 : 1;
+}
+
+// headless regression test and benchmark of the gesture pipeline on recorded sessions
+int main(int argc, char** argv) {
+  std::string log, capture;
+  std::string weights = std::format("{}/hand_classifier_v2.bin", MODEL_DIR);
+  double fps = 30.0;
+  int repeat = 1;
+  core::SpeculativeGestureDetector::Config config;
+  config.speculate = false;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--import") && i + 1 < argc)
+      capture = argv[++i];
+    else if (!strcmp(argv[i], "--fps") && i + 1 < argc)
+      fps = std::stod(argv[++i]);
+    else if (!strcmp(argv[i], "--weights") && i + 1 < argc)
+      weights = argv[++i];
+    else if (!strcmp(argv[i], "--repeat") && i + 1 < argc)
+      repeat = std::max(1, std::stoi(argv[++i]));
+    else if (!strcmp(argv[i], "--speculate"))
+      config.speculate = true;
+    else if (argv[i][0] != '-' && log.empty())
+      log = argv[i];
+    else {
+      log.clear();
+      break;
+    }
+  }
+  if (log.empty()) {
+    std::cout << "Usage: session-replay [log] [--weights path] [--speculate] [--repeat passes]" << std::endl;
+    std::cout << "       session-replay [log] --import [capture] [--fps rate] [--weights path] [--speculate]"
+              << std::endl;
+    return 0;
+  }
+  core::GestureModel model;
+  if (!model.load(weights))
+    return 1;
+  if (!capture.empty())
+    return importCapture(model, config, capture, log, fps);
+  return replayLog(model, config, log, repeat);
+}
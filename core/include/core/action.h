@@ -0,0 +1,48 @@
+#ifndef CORE_INCLUDE_CORE_ACTION_H_
+#define CORE_INCLUDE_CORE_ACTION_H_
+
+#include <core/event-ring.h>
+#include <cstdint>
+
+namespace core {
+enum class Action : uint8_t { Up, Down, Left, Right, Switch };
+
+// speculative input sources act on a gesture before it is certain: a Provisional action is applied right
+// away and later followed by a Confirmed or Retracted event for it; everything else is Final
+enum class ActionStatus : uint8_t { Final, Provisional, Confirmed, Retracted };
+
+struct ActionEvent {
+  Action action;
+  ActionStatus status{ActionStatus::Final};
+  // when the input source decided on the action; capture time travels in the queue's TimedEvent
+  int64_t emitNs{monotonicNs()};
+};
+
+// queue between an input source and the game loop
+using ActionQueue = EventRing<ActionEvent, 256>;
+
+// gesture ids produced by the classifier
+inline bool gestureToAction(int gesture, Action& action) {
+  switch (gesture) {
+    case 0:
+      action = Action::Left;
+      return true;
+    case 1:
+      action = Action::Up;
+      return true;
+    case 2:
+      action = Action::Down;
+      return true;
+    case 3:
+      action = Action::Right;
+      return true;
+    case 4:
+      action = Action::Switch;
+      return true;
+    default:
+      return false;
+  }
+}
+}
+
+#endif
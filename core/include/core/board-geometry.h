@@ -0,0 +1,27 @@
+#ifndef CORE_INCLUDE_CORE_BOARD_GEOMETRY_H_
+#define CORE_INCLUDE_CORE_BOARD_GEOMETRY_H_
+
+#include <core/map.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace core {
+// the triangles the game draws for a map: a square per tile in normalized device coordinates, exits in front
+// kept apart from OglRender so levels can be packed with their geometry (core/level-pack.h)
+struct BoardGeometry {
+  std::vector<glm::vec3> positions;
+  std::vector<glm::vec3> colors;
+  std::vector<uint32_t> idx;
+
+  void addSquare(float x, float y, float z, float width, float height, const glm::vec3& color);
+  // adds a square for every tile of map
+  void addTiles(const Map& map);
+  // appends prebuilt vertices
+  void append(std::span<const glm::vec3> positions, std::span<const glm::vec3> colors,
+              std::span<const uint32_t> idx);
+};
+}
+
+#endif
@@ -0,0 +1,127 @@
+#ifndef CORE_INCLUDE_CORE_DISTANCE_FIELD_H_
+#define CORE_INCLUDE_CORE_DISTANCE_FIELD_H_
+
+#include <core/action.h>
+#include <core/map.h>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace core {
+// fewest actions from every (tile, block color) to an exit under GameState's rules: a move may enter a Gray
+// tile, a tile of the block's color or an exit, and Switch is only safe standing on Gray
+// built by a breadth-first search backwards from all exits at once. Distances are kept per 64 x 64 chunk of
+// the map that holds anything, two 16-bit entries (Black, White) per tile next to a byte with the tile and
+// whether it is an exit, so the search never goes back to the Map (nor its exit index) and every query is a
+// directory load and an array load. Distances beyond 65534 saturate.
+class DistanceField {
+  public:
+    static constexpr uint16_t kUnreachable = 0xffff;
+
+    DistanceField() = default;
+    explicit DistanceField(const Map& map) {
+      build(map);
+    }
+    void build(const Map& map);
+    // the field of map from distances saved for it, without a search; false if they do not fit the map
+    bool restore(const Map& map, std::span<const uint16_t> distances);
+    // the Black and White distance of every non-empty tile, as restore takes them; an empty tile is never
+    // reachable
+    void saveDistances(std::vector<uint16_t>& out) const;
+    // brings the field up to date after the tiles (or exits) at changed were modified in map, searching only
+    // from the states whose distance changes
+    void update(const Map& map, std::span<const Point> changed);
+
+    [[nodiscard]] uint16_t distance(int x, int y, TileState color) const {
+      uint32_t s = state(x, y, color == TileState::White);
+      return s == kNoState ? kUnreachable : dist(s);
+    }
+    [[nodiscard]] uint16_t distance(Point p, TileState color) const {
+      return distance(p.x, p.y, color);
+    }
+    // an action that takes the block one step closer to an exit; false when it is on an exit or stuck
+    bool hint(Point p, TileState color, Action& action) const;
+    [[nodiscard]] bool solvable() const {
+      return solutionLength() != kUnreachable;
+    }
+    // from the start with a Black block, as the game begins
+    [[nodiscard]] uint16_t solutionLength() const {
+      return distance(start, TileState::Black);
+    }
+    // tile and color states from which an exit can be reached
+    [[nodiscard]] size_t reachableStates() const;
+    [[nodiscard]] size_t memoryBytes() const;
+
+  private:
+    static constexpr uint32_t kNoState = 0xffffffff;
+    static constexpr uint32_t kNoChunk = 0xffffffff;
+    static constexpr uint16_t kFar = kUnreachable - 1;
+    static constexpr uint8_t kTileMask = 3;
+    static constexpr uint8_t kExitBit = 4;
+    struct Chunk {
+      std::array<uint16_t, 2 * Map::kChunkTiles> dist;
+      // tile | kExitBit
+      std::array<uint8_t, Map::kChunkTiles> cells;
+    };
+
+    // a state is (chunk, tile in the chunk, color) packed as ((chunk << 12) | tile) << 1 | color
+    [[nodiscard]] uint32_t state(int x, int y, int color) const {
+      if (x < 0 || x >= width || y < 0 || y >= height)
+        return kNoState;
+      uint32_t chunk = directory[static_cast<size_t>(x >> Map::kChunkBits) * chunksY + (y >> Map::kChunkBits)];
+      if (chunk == kNoChunk)
+        return kNoState;
+      uint32_t tile = ((x & (Map::kChunkSize - 1)) << Map::kChunkBits) | (y & (Map::kChunkSize - 1));
+      return ((chunk << (2 * Map::kChunkBits)) | tile) << 1 | color;
+    }
+    [[nodiscard]] Point position(uint32_t s) const {
+      uint32_t tile = (s >> 1) & (Map::kChunkTiles - 1);
+      Point origin = origins[s >> (2 * Map::kChunkBits + 1)];
+      return {origin.x + static_cast<int>(tile >> Map::kChunkBits),
+              origin.y + static_cast<int>(tile & (Map::kChunkSize - 1))};
+    }
+    // the tile under state s and whether it is an exit
+    [[nodiscard]] uint8_t cell(uint32_t s) const {
+      return chunks[s >> (2 * Map::kChunkBits + 1)].cells[(s >> 1) & (Map::kChunkTiles - 1)];
+    }
+    [[nodiscard]] uint8_t& cell(uint32_t s) {
+      return chunks[s >> (2 * Map::kChunkBits + 1)].cells[(s >> 1) & (Map::kChunkTiles - 1)];
+    }
+    // the block can stand on the cell with this color
+    static bool live(uint8_t cell, int color) {
+      uint8_t tile = cell & kTileMask;
+      return tile == static_cast<uint8_t>(TileState::Gray) || tile == static_cast<uint8_t>(TileState::Black) + color;
+    }
+    [[nodiscard]] uint16_t& dist(uint32_t s) {
+      return chunks[s >> (2 * Map::kChunkBits + 1)].dist[s & (2 * Map::kChunkTiles - 1)];
+    }
+    [[nodiscard]] uint16_t dist(uint32_t s) const {
+      return chunks[s >> (2 * Map::kChunkBits + 1)].dist[s & (2 * Map::kChunkTiles - 1)];
+    }
+    void allocate(int x, int y);
+    // allocates the chunks of map and copies its tiles and exits, every distance unreachable
+    void layout(const Map& map);
+    // copies the tile and exit at (x, y) from the map
+    void load(const Map& map, int x, int y);
+    // fn(successor) for every state one action away from the (live, non-exit) state s
+    template <typename Fn>
+    void forEachSuccessor(uint32_t s, Fn&& fn) const;
+    // fn(predecessor) for every state with an action into s
+    template <typename Fn>
+    void forEachPredecessor(uint32_t s, Fn&& fn) const;
+    // distance of s worked out from its successors
+    [[nodiscard]] uint16_t settle(uint32_t s) const;
+    // passes the distances of the queued states on to every predecessor they improve
+    void propagate();
+
+    std::vector<Chunk> chunks;
+    std::vector<Point> origins;
+    std::vector<uint32_t> directory;
+    std::vector<uint32_t> queue, raised;
+    Point start;
+    int width{}, height{}, chunksY{};
+};
+}
+
+#endif
@@ -0,0 +1,169 @@
+#ifndef CORE_INCLUDE_CORE_EVENT_RING_H_
+#define CORE_INCLUDE_CORE_EVENT_RING_H_
+
+#include <core/timing.h>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace core {
+inline constexpr size_t kCacheLineSize = 64;
+
+namespace detail {
+// block while word == expected, at most timeoutNs (< 0 means forever). May wake spuriously.
+void futexWait(std::atomic<uint32_t>& word, uint32_t expected, int64_t timeoutNs);
+void futexWakeAll(std::atomic<uint32_t>& word);
+}
+
+// an event as it travels through the input pipeline
+// seq is assigned by the producer for every event it sees, including the ones that were dropped,
+// so a gap in seq on the consumer side is exactly the number of lost events
+template <typename T>
+struct TimedEvent {
+  T value{};
+  uint64_t seq{};
+  int64_t captureNs{};
+};
+
+// bounded lock-free single-producer/single-consumer ring
+// push/pop never allocate; when the ring is full the new event is dropped and counted.
+// the consumer may block in waitPop, which sleeps on a futex word that the producer only touches
+// when the consumer is actually asleep.
+template <typename T, size_t Capacity>
+class EventRing {
+  static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+  public:
+    using Event = TimedEvent<T>;
+    EventRing() = default;
+    EventRing(const EventRing&) = delete;
+    EventRing& operator=(const EventRing&) = delete;
+
+    // producer side
+    bool tryPush(const T& value, int64_t captureNs = monotonicNs()) {
+      uint64_t seq = nextSeq++;
+      uint64_t t = tail.load(std::memory_order_relaxed);
+      if (t - cachedHead == Capacity) {
+        cachedHead = head.load(std::memory_order_acquire);
+        if (t - cachedHead == Capacity) {
+          dropped.fetch_add(1, std::memory_order_relaxed);
+          return false;
+        }
+      }
+      Event& slot = slots[t & kMask];
+      slot.value = value;
+      slot.seq = seq;
+      slot.captureNs = captureNs;
+      tail.store(t + 1, std::memory_order_release);
+      // pairs with the fence in waitFor: either we see the consumer asleep, or it sees our tail
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (sleeping.load(std::memory_order_relaxed)) {
+        signal.fetch_add(1, std::memory_order_relaxed);
+        detail::futexWakeAll(signal);
+      }
+      return true;
+    }
+
+    // consumer side
+    bool tryPop(Event& out) {
+      uint64_t h = head.load(std::memory_order_relaxed);
+      if (h == cachedTail) {
+        cachedTail = tail.load(std::memory_order_acquire);
+        if (h == cachedTail)
+          return false;
+      }
+      out = slots[h & kMask];
+      head.store(h + 1, std::memory_order_release);
+      return true;
+    }
+    // hand every pending event (at most maxCount) to fn in order, releasing the slots in one store
+    template <typename Fn>
+    size_t drain(Fn&& fn, size_t maxCount = Capacity) {
+      uint64_t h = head.load(std::memory_order_relaxed);
+      cachedTail = tail.load(std::memory_order_acquire);
+      uint64_t n = cachedTail - h;
+      if (n > maxCount)
+        n = maxCount;
+      for (uint64_t i = 0; i < n; i++)
+        fn(static_cast<const Event&>(slots[(h + i) & kMask]));
+      if (n)
+        head.store(h + n, std::memory_order_release);
+      return n;
+    }
+    size_t popBatch(Event* out, size_t maxCount) {
+      return drain([&out](const Event& e) { *out++ = e; }, maxCount);
+    }
+    // wait until an event is available, timeoutNs elapsed (< 0 means forever) or the ring is closed
+    bool waitFor(Event& out, int64_t timeoutNs) {
+      int64_t deadline = timeoutNs < 0 ? 0 : monotonicNs() + timeoutNs;
+      for (;;) {
+        if (tryPop(out))
+          return true;
+        uint32_t observed = signal.load(std::memory_order_acquire);
+        if (closed.load(std::memory_order_acquire))
+          return false;
+        sleeping.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (tail.load(std::memory_order_relaxed) != head.load(std::memory_order_relaxed)) {
+          sleeping.store(0, std::memory_order_relaxed);
+          continue;
+        }
+        int64_t remaining = -1;
+        if (timeoutNs >= 0) {
+          remaining = deadline - monotonicNs();
+          if (remaining <= 0) {
+            sleeping.store(0, std::memory_order_relaxed);
+            return tryPop(out);
+          }
+        }
+        detail::futexWait(signal, observed, remaining);
+        sleeping.store(0, std::memory_order_relaxed);
+      }
+    }
+    bool waitPop(Event& out) {
+      return waitFor(out, -1);
+    }
+    // release a consumer blocked in waitFor, e.g. on shutdown. Pending events can still be popped.
+    void close() {
+      closed.store(true, std::memory_order_release);
+      signal.fetch_add(1, std::memory_order_release);
+      detail::futexWakeAll(signal);
+    }
+
+    // statistics, safe to read from any thread
+    [[nodiscard]] size_t size() const {
+      return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+    [[nodiscard]] bool empty() const {
+      return size() == 0;
+    }
+    [[nodiscard]] uint64_t pushedCount() const {
+      return tail.load(std::memory_order_relaxed);
+    }
+    [[nodiscard]] uint64_t droppedCount() const {
+      return dropped.load(std::memory_order_relaxed);
+    }
+    static constexpr size_t capacity() {
+      return Capacity;
+    }
+
+  private:
+    static constexpr uint64_t kMask = Capacity - 1;
+    // producer-owned line
+    alignas(kCacheLineSize) std::atomic<uint64_t> tail{0};
+    uint64_t cachedHead{0};
+    uint64_t nextSeq{0};
+    std::atomic<uint64_t> dropped{0};
+    // consumer-owned line
+    alignas(kCacheLineSize) std::atomic<uint64_t> head{0};
+    uint64_t cachedTail{0};
+    // wakeup line, only written when the consumer sleeps
+    alignas(kCacheLineSize) std::atomic<uint32_t> signal{0};
+    std::atomic<uint32_t> sleeping{0};
+    std::atomic_bool closed{false};
+    alignas(kCacheLineSize) std::array<Event, Capacity> slots{};
+};
+}
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef CORE_INCLUDE_CORE_GAME_BATCH_H_
+#define CORE_INCLUDE_CORE_GAME_BATCH_H_
+
+#include <core/game-state.h>
+#include <core/map.h>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace core {
+// many headless games stepped together, for scripted or AI-driven runs (difficulty tuning, bots)
+// the rules are GameState's for final actions; there are no provisional moves and nothing is drawn.
+// Games are kept as structure of arrays so a tick moves every game in one vectorizable pass, and each
+// level is flattened into a byte per tile so the rule checks are a single load.
+class GameBatch {
+  public:
+    // no action this tick, any other value is an Action
+    static constexpr uint8_t kIdle = 0xff;
+    // fills actions[0, end - begin) for games [begin, end) at a tick; called concurrently for disjoint ranges
+    using Policy = std::function<void(const GameBatch& batch, int begin, int end, int64_t tick, uint8_t* actions)>;
+    struct Summary {
+      int64_t games{}, finished{}, failed{}, running{}, reachedExit{}, moves{};
+    };
+
+    // the map is copied into the batch, returns the level's index
+    int addLevel(const Map& map);
+    // a game at the level's start, started at time now
+    int addGame(int level, double now = 0.0);
+    // every game back to its start
+    void reset(double now = 0.0);
+
+    // one tick for games [begin, end): apply actions[i - begin] to game i, then check the rules at time now
+    // returns how many of those games are still running
+    int step(int begin, int end, const uint8_t* actions, double now);
+    // steps every game from time start in ticks of dt until it ends or maxTicks have passed, the games split
+    // into contiguous ranges over threads (<= 0 for every hardware thread)
+    void run(const Policy& policy, double start, double dt, int64_t maxTicks, int threads = 0);
+
+    [[nodiscard]] int size() const {
+      return static_cast<int>(xs.size());
+    }
+    [[nodiscard]] Point position(int game) const {
+      return {xs[game], ys[game]};
+    }
+    [[nodiscard]] TileState color(int game) const {
+      return static_cast<TileState>(colors[game]);
+    }
+    [[nodiscard]] GameEnd ending(int game) const {
+      return static_cast<GameEnd>(endings[game]);
+    }
+    [[nodiscard]] int level(int game) const {
+      return levelOf[game];
+    }
+    [[nodiscard]] int32_t moveCount(int game) const {
+      return moves[game];
+    }
+    // seconds from the game's start to its end, or to its last step while it runs
+    [[nodiscard]] double elapsed(int game) const {
+      return lastTimes[game] - startTimes[game];
+    }
+    [[nodiscard]] bool reachedExit(int game) const {
+      return cell(levelOf[game], xs[game], ys[game]) & kExitBit;
+    }
+    // the tile at (x, y) of a level, Empty outside it; lets policies look around without the Map
+    [[nodiscard]] TileState tile(int level, int x, int y) const {
+      return static_cast<TileState>(cell(level, x, y) & kTileMask);
+    }
+    [[nodiscard]] Summary summary() const;
+
+  private:
+    static constexpr uint8_t kTileMask = 3;
+    static constexpr uint8_t kExitBit = 4;
+    struct Level {
+      // tile | kExitBit, column after column
+      std::vector<uint8_t> cells;
+      int width{}, height{};
+      Point start;
+    };
+    // the rules for games [begin, end) where they stand, returns how many are still running
+    int checkRules(int begin, int end, double now);
+    [[nodiscard]] uint8_t cell(int level, int x, int y) const {
+      const Level& l = levels[level];
+      if (static_cast<uint32_t>(x) >= static_cast<uint32_t>(l.width)
+          || static_cast<uint32_t>(y) >= static_cast<uint32_t>(l.height))
+        return 0;
+      return l.cells[static_cast<size_t>(x) * l.height + y];
+    }
+
+    std::vector<Level> levels;
+    std::vector<int32_t> xs, ys, moves, levelOf;
+    std::vector<uint8_t> colors, endings;
+    std::vector<double> startTimes, lastTimes;
+};
+}
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef CORE_INCLUDE_CORE_GAME_SIMULATION_H_
+#define CORE_INCLUDE_CORE_GAME_SIMULATION_H_
+
+#include <core/action.h>
+#include <core/game-state.h>
+#include <core/latency-trace.h>
+#include <core/triple-buffer.h>
+#include <glm/glm.hpp>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+namespace core {
+// what the renderer needs of one simulation tick, never modified once published
+struct GameSnapshot {
+  Point pos, lastOperationPos;
+  TileState color{TileState::Black};
+  GameEnd ending{GameEnd::Running};
+  double lastOperationTime{};
+  uint64_t tick{};
+  // actions applied up to this tick; capture time of the oldest action the renderer has not picked up in a
+  // snapshot yet, carried over from tick to tick until it has, 0 without any, and when it was first published
+  // (this snapshot's own time without one)
+  uint64_t actions{};
+  int64_t captureNs{}, publishedNs{};
+
+  // where the block is drawn at time now, in normalized device coordinates, sliding from the last position
+  // for kOperationInterval after every move
+  [[nodiscard]] glm::vec2 displayPos(const Map& map, double now) const;
+};
+
+// runs GameState on its own thread at a fixed tick rate, decoupled from rendering and the display's refresh
+// every tick takes all pending actions, applying and checking each in order, and publishes a snapshot
+// through a triple buffer; the renderer picks up the newest one whenever it draws
+class GameSimulation {
+  public:
+    struct Config {
+      double tickRate = 250.0;
+    };
+    struct Stats {
+      uint64_t ticks{}, actions{}, maxActionsPerTick{}, lateTicks{};
+    };
+
+    // the map, queue, clock and trace (optional) must outlive the simulation; the clock is read from both
+    // the simulation thread and the renderer
+    GameSimulation(const Map& map, ActionQueue& actions, const Clock& clock, Config config,
+                   LatencyTrace* trace = nullptr);
+    GameSimulation(const GameSimulation&) = delete;
+    GameSimulation& operator=(const GameSimulation&) = delete;
+    ~GameSimulation();
+    void start();
+    void stop();
+
+    // renderer side: the newest snapshot, fresh is set when it was published since the last call
+    const GameSnapshot& latest(bool* fresh = nullptr);
+    [[nodiscard]] Stats stats() const;
+
+  private:
+    void run();
+    void publish(int64_t captureNs);
+
+    const Map& map;
+    ActionQueue& actions;
+    const Clock& clock;
+    Config config;
+    LatencyTrace* trace;
+    GameState state;
+    TripleBuffer<GameSnapshot> snapshots;
+    // simulation side: the capture time every snapshot carries until the renderer has acquired one with it, and
+    // when it was first published
+    int64_t pendingCaptureNs = 0, pendingPublishedNs = 0;
+    // renderer side: the capture time of the snapshot acquired last
+    std::atomic<int64_t> acquiredCaptureNs{0};
+    std::atomic<uint64_t> ticks{0}, applied{0}, maxPerTick{0}, late{0};
+    std::atomic_bool running{false};
+    std::unique_ptr<std::thread> thread;
+};
+}
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef CORE_INCLUDE_CORE_GAME_STATE_H_
+#define CORE_INCLUDE_CORE_GAME_STATE_H_
+
+#include <core/action.h>
+#include <core/map.h>
+#include <core/timing.h>
+#include <array>
+#include <optional>
+
+namespace core {
+constexpr double kOperationInterval = 0.2; // sec
+constexpr double kMaxGameTime = 60.0; // sec
+
+// the step GameState::move takes for Up, Down, Left and Right (unlike the map generator's coordChanges)
+inline const std::array<Point, 4> moveSteps{
+  Point(-1, 0),
+  Point(1, 0),
+  Point(0, -1),
+  Point(0, 1),
+};
+
+enum class GameEnd : uint8_t {
+  Finished,
+  Failed,
+  Running,
+};
+
+// one player on one map; time comes from the clock, so the same state drives the window and headless runs
+struct GameState {
+  GameState(Point p, const Clock& clock) : pos(p), time(clock.now()), startTime(time), clock(&clock) {
+  }
+  void move(const Map& map, Action action);
+  // provisional moves are shown right away but can be taken back until they are confirmed
+  void apply(const Map& map, ActionEvent event);
+  void update(const Map& map);
+
+  GameEnd ending{GameEnd::Running};
+  Point pos, lastOperationPos{};
+  TileState color{TileState::Black};
+  double time{}, lastOperationTime{}, startTime{};
+  struct Snapshot {
+    Point pos;
+    TileState color;
+  };
+  std::optional<Snapshot> tentative;
+  const Clock* clock;
+};
+}
+
+#endif
@@ -0,0 +1,141 @@
+#ifndef CORE_INCLUDE_CORE_GESTURE_MODEL_H_
+#define CORE_INCLUDE_CORE_GESTURE_MODEL_H_
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace core {
+// gesture id reported when no class is confident enough, same as PointHistoryClassifier's invalid_value
+inline constexpr int kInvalidGesture = 998;
+
+// native implementation of hand_classifier_v2:
+// batch norm -> LSTM (return sequences) -> LSTM -> dense + relu -> dense + softmax
+// weights come from the flat file written by hand_test/hand_test/export_weights.py
+// matrix products and the LSTM cell update use AVX2/FMA when the CPU has them and scalar loops otherwise
+class GestureModel {
+  public:
+    enum class Kernel { Scalar, Avx2 };
+    GestureModel() = default;
+    // prints the reason and returns false if the file is missing or malformed
+    bool load(const std::string& path);
+    // window holds timeSteps() x inputDim() normalised keypoints, probabilities receives numClasses() values
+    void predict(const float* window, float* probabilities);
+    // evaluate count windows at once, probabilities receives count x numClasses() values
+    // the weights are streamed once per batch instead of once per window; results are bit-identical to
+    // calling predict on each window
+    void predictBatch(const float* const* windows, int count, float* probabilities);
+    // size the batch scratch space up front so predictBatch does not allocate
+    void reserveBatch(int count);
+    // most likely class, or kInvalidGesture when its probability is below threshold
+    int classify(const float* window, float threshold, float* confidence = nullptr);
+    int pickGesture(const float* probabilities, float threshold, float* confidence = nullptr) const;
+    // run every window of a reference file written by hand_test/hand_test/export_reference.py
+    // and compare with the TFLite probabilities stored next to it
+    bool validate(const std::string& referencePath, float tolerance, std::ostream& log = std::cout);
+
+    // the best kernel the CPU supports is selected on load; forcing Avx2 on a CPU without it is ignored
+    void setKernel(Kernel k);
+    [[nodiscard]] Kernel kernel() const {
+      return activeKernel;
+    }
+    [[nodiscard]] bool loaded() const {
+      return numClasses_ > 0;
+    }
+    [[nodiscard]] int timeSteps() const {
+      return timeSteps_;
+    }
+    [[nodiscard]] int inputDim() const {
+      return inputDim_;
+    }
+    [[nodiscard]] int windowSize() const {
+      return timeSteps_ * inputDim_;
+    }
+    [[nodiscard]] int numClasses() const {
+      return numClasses_;
+    }
+    // multiply-add work of one full window evaluation, and of the part of it that only depends on
+    // the input of a single time step (normalisation and the first layer's input projection)
+    [[nodiscard]] int64_t flopsPerWindow() const;
+    [[nodiscard]] int64_t flopsPerInputStep() const;
+
+  private:
+    friend class GestureStream;
+    struct LstmLayer {
+      int inputDim{}, units{};
+      // keras layout: kernel is inputDim x 4 units, recurrent is units x 4 units, gate order i, f, c, o
+      std::vector<float> kernel, recurrent, bias;
+    };
+    struct DenseLayer {
+      int inputDim{}, units{};
+      std::vector<float> kernel, bias;
+    };
+    using GemvFn = void (*)(const float* x, int n, const float* w, int cols, float* out);
+    using GemmFn = void (*)(const float* x, int rows, int ldx, int n, const float* w, int cols, float* out, int ldo);
+    using CellFn = void (*)(int units, const float* gates, float* h, float* c);
+    void normalize(const float* x, float* out) const;
+    // gates = bias + x * kernel, the part of a step that only depends on the input
+    void projectInput(const LstmLayer& layer, const float* x, float* gates) const;
+    // gates += h * recurrent, then the cell update; h and c are updated in place
+    void recurrentStep(const LstmLayer& layer, float* gates, float* h, float* c) const;
+    static void softmax(float* logits, int n);
+    void dense(const DenseLayer& layer, const float* x, float* out) const;
+    // everything after the first layer's input projections, which are read from a ring of timeSteps()
+    // slots of 4 * units floats starting at slot first; steps below timeSteps() run the LSTMs over a
+    // shorter sequence
+    void evaluate(const float* projections, int first, int steps, float* probabilities);
+
+    int timeSteps_{}, inputDim_{}, numClasses_{};
+    // batch norm folded into a per-channel affine transform
+    std::vector<float> bnScale, bnShift;
+    LstmLayer lstm1, lstm2;
+    DenseLayer dense1, dense2;
+    Kernel activeKernel{Kernel::Scalar};
+    GemvFn gemv{};
+    GemmFn gemm{};
+    CellFn cellUpdate{};
+    // scratch space, sized on load so predict never allocates
+    std::vector<float> normalized, projections, gates, sequence, h1, c1, h2, c2, hidden;
+    // the same for predictBatch, rows of one window each
+    struct {
+      std::vector<float> normalized, gates, sequence, h1, c1, h2, c2, hidden;
+    } batch;
+    int batchCapacity{};
+};
+
+// classification of a window that slides by one frame at a time
+// the normalisation and first-layer input projection of a frame do not depend on its position in the
+// window, so they are computed once when the frame arrives and kept in a ring; each new frame then costs
+// one projection plus the recurrent passes. Results are bit-identical to GestureModel::predict on the
+// same window since both run the same kernels in the same order.
+class GestureStream {
+  public:
+    explicit GestureStream(GestureModel& model);
+    // add the newest frame (inputDim() preprocessed values)
+    // returns true and writes probabilities once timeSteps() frames have been seen
+    bool push(const float* frame, float* probabilities);
+    // add the newest frame without classifying
+    void append(const float* frame);
+    // classify only the newest steps frames, e.g. before the window has filled or to react to a gesture
+    // that has just started; returns false if fewer frames have been seen
+    bool predictRecent(int steps, float* probabilities);
+    void reset();
+    [[nodiscard]] int64_t framesSeen() const {
+      return frames;
+    }
+    // work skipped compared to re-evaluating the whole window on every frame
+    [[nodiscard]] int64_t flopsSavedPerFrame() const;
+    [[nodiscard]] int64_t flopsSaved() const {
+      return totalSaved;
+    }
+
+  private:
+    GestureModel& model;
+    std::vector<float> ring;
+    int head{};
+    int64_t frames{}, totalSaved{};
+};
+}
+
+#endif
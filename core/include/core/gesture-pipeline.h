@@ -0,0 +1,28 @@
+#ifndef CORE_INCLUDE_CORE_GESTURE_PIPELINE_H_
+#define CORE_INCLUDE_CORE_GESTURE_PIPELINE_H_
+
+#include <core/gesture-speculation.h>
+#include <core/keypoint-window.h>
+#include <core/session-log.h>
+
+namespace core {
+// raw keypoint frames in, game actions out: normalisation, the sliding window and gesture detection,
+// shared by the live device adapter and replay so both run exactly the same code
+class GesturePipeline {
+  public:
+    GesturePipeline(GestureModel& model, SpeculativeGestureDetector::Config config);
+    // pushes the actions the frame produced (at most kMaxActions) and returns how many; with a log, the frame,
+    // the detected gestures and the actions are recorded too
+    int push(const KeypointFrame& frame, int64_t captureNs, ActionQueue& actions, SessionLogWriter* log = nullptr);
+    [[nodiscard]] const SpeculativeGestureDetector& detector() const {
+      return detector_;
+    }
+    static constexpr int kMaxActions = SpeculativeGestureDetector::kMaxEvents;
+
+  private:
+    KeypointWindow<> window;
+    SpeculativeGestureDetector detector_;
+};
+}
+
+#endif
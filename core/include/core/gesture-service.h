@@ -0,0 +1,92 @@
+#ifndef CORE_INCLUDE_CORE_GESTURE_SERVICE_H_
+#define CORE_INCLUDE_CORE_GESTURE_SERVICE_H_
+
+#include <core/action.h>
+#include <core/gesture-model.h>
+#include <core/keypoint-window.h>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace core {
+// classifies windows from many independent streams (players, hands) on one worker thread
+// every tick the worker takes what is pending across all streams and evaluates it as one batch; a batch
+// that is not full waits for more windows, but never longer than maxLatencyNs after its oldest window
+// was submitted. Results go to each stream's action queue.
+class GestureService {
+  public:
+    struct Config {
+      int maxBatch = 16;
+      int64_t maxLatencyNs = 2'000'000;
+      float threshold = 0.95f;
+    };
+    struct Stats {
+      uint64_t batches{}, windows{}, dropped{};
+      int64_t maxLatencyNs{}, totalLatencyNs{};
+    };
+    // called on the worker thread for every classified window, e.g. to measure latency
+    using ResultFn = std::function<void(int stream, int gesture, float confidence, int64_t captureNs,
+                                        int64_t submitNs)>;
+    using Window = std::array<float, kWindowFrames * kKeypointDim>;
+
+    // the model is copied, the service owns its scratch space
+    GestureService(const GestureModel& model, Config config);
+    GestureService(const GestureService&) = delete;
+    GestureService& operator=(const GestureService&) = delete;
+    ~GestureService();
+    // register all streams before start(); actions receives the stream's gestures as they start
+    int addStream(ActionQueue& actions);
+    void onResult(ResultFn fn) {
+      resultFn = std::move(fn);
+    }
+    void start();
+    void stop();
+    // producer side, at most one thread per stream; the window is copied
+    // returns false (and counts a drop) when the stream already has too many windows in flight
+    bool submit(int stream, std::span<const float> window, int64_t captureNs);
+    [[nodiscard]] Stats stats() const;
+
+  private:
+    struct Job {
+      Window window;
+      int64_t submitNs;
+    };
+    struct Stream {
+      EventRing<Job, 4> pending;
+      ActionQueue* actions;
+      int prevGesture{kInvalidGesture};
+    };
+    struct Slot {
+      int stream;
+      int64_t captureNs, submitNs;
+    };
+    void run();
+    int collect(int count);
+    void evaluate(int count);
+    void waitForWork(int64_t timeoutNs);
+
+    GestureModel model;
+    Config config;
+    ResultFn resultFn;
+    std::vector<std::unique_ptr<Stream>> streams;
+    int nextStream{};
+    // batch being assembled by the worker
+    std::vector<Window> windows;
+    std::vector<const float*> windowPtrs;
+    std::vector<Slot> slots;
+    std::vector<float> probabilities;
+    // producers bump wakeWord when the worker sleeps, same protocol as EventRing
+    alignas(kCacheLineSize) std::atomic<uint32_t> wakeWord{0};
+    std::atomic<uint32_t> sleeping{0};
+    alignas(kCacheLineSize) std::atomic<uint64_t> batches{0}, processed{0};
+    std::atomic<int64_t> maxLatency{0}, totalLatency{0};
+    std::atomic_bool running{false};
+    std::unique_ptr<std::thread> worker;
+};
+}
+
+#endif
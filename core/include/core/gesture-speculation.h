@@ -0,0 +1,69 @@
+#ifndef CORE_INCLUDE_CORE_GESTURE_SPECULATION_H_
+#define CORE_INCLUDE_CORE_GESTURE_SPECULATION_H_
+
+#include <core/action.h>
+#include <core/gesture-model.h>
+#include <cstdint>
+#include <vector>
+
+namespace core {
+struct GestureEvent {
+  int gesture;
+  ActionStatus status;
+  float confidence;
+};
+
+// gesture detection that does not wait for a full window
+// besides the full window, every frame also classifies the newest few frames (or whatever has arrived
+// before the window filled). A short window above earlyThreshold emits a Provisional gesture, which is
+// Confirmed as soon as the full window agrees and Retracted when it disagrees or does not agree in time.
+// Without speculation the output is exactly the edge-triggered full-window result the game used before.
+class SpeculativeGestureDetector {
+  public:
+    struct Config {
+      // full window, same as PointHistoryClassifier's score_th
+      float threshold = 0.95f;
+      // a short window must be at least this confident to act on
+      float earlyThreshold = 0.99f;
+      // newest frames a short window covers once the full window is available
+      int earlySteps = 12;
+      // no speculation on fewer frames than this
+      int minSteps = 8;
+      // frames a provisional gesture may wait for the full window to agree
+      int confirmFrames = 23;
+      bool speculate = true;
+    };
+    struct Stats {
+      uint64_t frames{}, finals{}, provisional{}, confirmed{}, retracted{};
+      // frames between a provisional gesture and the full window reporting it, summed over confirmations
+      uint64_t framesSaved{};
+    };
+    // a frame produces at most a retraction, a final gesture and a new provisional one
+    static constexpr int kMaxEvents = 3;
+
+    SpeculativeGestureDetector(GestureModel& model, Config config);
+    // add one preprocessed frame, writes up to kMaxEvents events and returns how many
+    int push(const float* frame, GestureEvent* events);
+    void reset();
+    [[nodiscard]] const Stats& stats() const {
+      return counters;
+    }
+    [[nodiscard]] const Config& options() const {
+      return config;
+    }
+
+  private:
+    GestureModel& model;
+    Config config;
+    GestureStream stream;
+    std::vector<float> full, recent;
+    // last full-window and short-window results, events are only produced when they change
+    int prevFinal{kInvalidGesture}, prevEarly{kInvalidGesture};
+    int pending{kInvalidGesture};
+    float pendingConfidence{};
+    uint64_t pendingFrame{};
+    Stats counters;
+};
+}
+
+#endif
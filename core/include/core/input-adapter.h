@@ -0,0 +1,33 @@
+#ifndef CORE_INCLUDE_CORE_INPUT_ADAPTER_H_
+#define CORE_INCLUDE_CORE_INPUT_ADAPTER_H_
+
+#include <core/action.h>
+#include <core/gesture-model.h>
+#include <cstdint>
+#include <cstdio>
+
+namespace core {
+// a source of game actions, running on its own thread and feeding buffer
+struct InputAdapter {
+  virtual void inputAction() = 0;
+  virtual ~InputAdapter() = default;
+  ActionQueue buffer;
+};
+
+// parses the gesture ids a classifier script prints (hand_side.py, input-gen gestures), skipping
+// kInvalidGesture
+class GestureIdFilter {
+  public:
+    // echo prints every id read, as the game does
+    explicit GestureIdFilter(bool echo = false) : echo(echo) {
+    }
+    // the next gesture id and when it was read, -1 at the end of the stream
+    int next(FILE* in, int64_t& captureNs);
+
+  private:
+    int prev{kInvalidGesture};
+    bool echo;
+};
+}
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef CORE_INCLUDE_CORE_KEYPOINT_WINDOW_H_
+#define CORE_INCLUDE_CORE_KEYPOINT_WINDOW_H_
+
+#include <core/event-ring.h>
+#include <core/serial-reader.h>
+#include <array>
+#include <cmath>
+#include <span>
+
+namespace core {
+inline constexpr int kWindowFrames = 23;
+
+enum class HandNormalization {
+  // what hand_side.py actually computes and the model was trained on: ref_point there is a view into the
+  // frame, so only the wrist ends up at the origin, and everything is scaled by the raw keypoint 17
+  HandSide,
+  // the documented intent: every keypoint relative to the wrist, scaled by the wrist to keypoint 17 distance
+  WristRelative,
+};
+
+// normalise one frame of Dim values (x, y pairs) into out in a single pass
+// a degenerate hand whose scale keypoint sits on the reference point yields an all-zero frame
+template <int Dim = kKeypointDim>
+void normalizeHandSize(const float* in, float* out, HandNormalization mode = HandNormalization::HandSide) {
+  static_assert(Dim >= 36 && Dim % 2 == 0, "frame must hold keypoint 17 as x, y pairs");
+  float refX = 0.f, refY = 0.f;
+  if (mode == HandNormalization::WristRelative) {
+    refX = in[0];
+    refY = in[1];
+  }
+  float scale = std::hypot(in[34] - refX, in[35] - refY);
+  float inv = scale > 0.f ? 1.f / scale : 0.f;
+  for (int i = 0; i < Dim; i += 2) {
+    out[i] = (in[i] - refX) * inv;
+    out[i + 1] = (in[i + 1] - refY) * inv;
+  }
+  out[0] = 0.f;
+  out[1] = 0.f;
+}
+
+// the last Frames normalised keypoint frames, oldest first
+// every frame is stored twice, Frames slots apart, so the window starting at any slot is one contiguous
+// run of floats: pushing costs two short stores and the classifier reads the window in place
+template <int Frames = kWindowFrames, int Dim = kKeypointDim>
+class KeypointWindow {
+  public:
+    explicit KeypointWindow(HandNormalization mode = HandNormalization::HandSide) : mode(mode) {
+    }
+    // normalise a raw frame into the window, evicting the oldest frame once it is full
+    void push(const float* raw) {
+      int slot = count < Frames ? count : head;
+      float* first = storage.data() + slot * Dim;
+      float* mirror = first + Frames * Dim;
+      normalizeHandSize<Dim>(raw, first, mode);
+      for (int i = 0; i < Dim; i++)
+        mirror[i] = first[i];
+      if (count < Frames)
+        count++;
+      else
+        head = head + 1 == Frames ? 0 : head + 1;
+    }
+    void push(const KeypointFrame& raw) requires (Dim == kKeypointDim) {
+      push(raw.data());
+    }
+    void clear() {
+      head = 0;
+      count = 0;
+    }
+    [[nodiscard]] bool full() const {
+      return count == Frames;
+    }
+    [[nodiscard]] int size() const {
+      return count;
+    }
+    static constexpr int capacity() {
+      return Frames;
+    }
+    static constexpr int frameSize() {
+      return Dim;
+    }
+    // size() * Dim floats, oldest frame first, valid until the next push
+    [[nodiscard]] std::span<const float> view() const {
+      return {storage.data() + head * Dim, static_cast<size_t>(count) * Dim};
+    }
+    [[nodiscard]] const float* data() const {
+      return storage.data() + head * Dim;
+    }
+    [[nodiscard]] std::span<const float, Dim> newest() const {
+      int slot = count < Frames ? count - 1 : (head + Frames - 1) % Frames;
+      return std::span<const float, Dim>(storage.data() + slot * Dim, Dim);
+    }
+
+  private:
+    alignas(kCacheLineSize) std::array<float, 2 * Frames * Dim> storage{};
+    int head{}, count{};
+    HandNormalization mode;
+};
+}
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef CORE_INCLUDE_CORE_LATENCY_TRACE_H_
+#define CORE_INCLUDE_CORE_LATENCY_TRACE_H_
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <iostream>
+
+namespace core {
+// lock-free log-linear histogram of nanosecond latencies, in the spirit of HdrHistogram
+// values below 64 ns get a bucket each, above that every power of two is split into 32 buckets, so a
+// percentile is within about 3% of the true value. Recording is a handful of relaxed atomic adds and
+// may happen from any number of threads; readers see a consistent enough snapshot for reporting.
+class LatencyHistogram {
+  public:
+    static constexpr int kSubBucketBits = 5;
+    static constexpr int kSubBuckets = 1 << kSubBucketBits;
+    // values up to 2^40 ns (about 18 minutes), larger ones land in the last bucket
+    static constexpr int kMaxExponent = 40;
+    static constexpr int kBuckets = (kMaxExponent - kSubBucketBits + 1) * kSubBuckets + kSubBuckets;
+
+    void record(int64_t ns) {
+      uint64_t v = ns > 0 ? static_cast<uint64_t>(ns) : 0;
+      buckets[bucketOf(v)].fetch_add(1, std::memory_order_relaxed);
+      total.fetch_add(1, std::memory_order_relaxed);
+      sum.fetch_add(v, std::memory_order_relaxed);
+      uint64_t seen = maximum.load(std::memory_order_relaxed);
+      while (v > seen && !maximum.compare_exchange_weak(seen, v, std::memory_order_relaxed)) {
+      }
+    }
+    // value at quantile q in [0, 1], the middle of the bucket it falls in
+    [[nodiscard]] int64_t percentile(double q) const;
+    [[nodiscard]] uint64_t count() const {
+      return total.load(std::memory_order_relaxed);
+    }
+    [[nodiscard]] int64_t max() const {
+      return static_cast<int64_t>(maximum.load(std::memory_order_relaxed));
+    }
+    [[nodiscard]] double mean() const {
+      uint64_t n = count();
+      return n ? static_cast<double>(sum.load(std::memory_order_relaxed)) / n : 0.0;
+    }
+    void reset();
+
+    static int bucketOf(uint64_t v) {
+      if (v < 2 * kSubBuckets)
+        return static_cast<int>(v);
+      int shift = std::bit_width(v) - 1 - kSubBucketBits;
+      if (shift > kMaxExponent - kSubBucketBits)
+        return kBuckets - 1;
+      return shift * kSubBuckets + static_cast<int>(v >> shift);
+    }
+    // smallest value that falls into bucket i
+    static uint64_t bucketStart(int i) {
+      if (i < 2 * kSubBuckets)
+        return i;
+      int shift = i / kSubBuckets - 1;
+      return static_cast<uint64_t>(i % kSubBuckets + kSubBuckets) << shift;
+    }
+
+  private:
+    std::array<std::atomic<uint64_t>, kBuckets> buckets{};
+    std::atomic<uint64_t> total{0}, sum{0}, maximum{0};
+};
+
+// stages an input event passes through between the keypoint frame and the frame showing its effect
+enum class TraceStage : uint8_t {
+  // capture to the input source emitting an action: framing, windowing, classification
+  Classify,
+  // emitted to picked up by the simulation tick
+  Queue,
+  // GameState::apply and update until the tick's snapshot is published
+  Apply,
+  // published to uploaded by the renderer (OglDisplayer::updateBlockData)
+  Upload,
+  // draw and glfwSwapBuffers
+  Present,
+  // capture to swap
+  Total,
+  Count,
+};
+
+// per-stage latency histograms, always on
+class LatencyTrace {
+  public:
+    void record(TraceStage stage, int64_t ns) {
+      stages[static_cast<int>(stage)].record(ns);
+    }
+    void record(TraceStage stage, int64_t beginNs, int64_t endNs) {
+      record(stage, endNs - beginNs);
+    }
+    [[nodiscard]] const LatencyHistogram& histogram(TraceStage stage) const {
+      return stages[static_cast<int>(stage)];
+    }
+    // p50/p95/p99/max table of every stage that has seen events
+    void summary(std::ostream& out) const;
+    void reset();
+
+    // a signal (SIGUSR1 by default) only sets a flag; the owner polls it and prints the summary
+    static void installSignalHandler(int signal);
+    static bool signalled();
+
+  private:
+    std::array<LatencyHistogram, static_cast<int>(TraceStage::Count)> stages;
+};
+}
+
+#endif
@@ -0,0 +1,137 @@
+#ifndef CORE_INCLUDE_CORE_LEVEL_PACK_H_
+#define CORE_INCLUDE_CORE_LEVEL_PACK_H_
+
+#include <core/board-geometry.h>
+#include <core/distance-field.h>
+#include <core/map.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace core {
+// binary level pack: a 32 byte file header padded to 64, the levels, then an index with the offset of every level
+// a level is a 64 byte header followed by its sections, each 64 byte aligned: Map's tile chunks, chunk
+// directory, exits and sorted exit keys, then optionally the distance field and the board geometry. Everything
+// is stored as the program holds it in memory, so the reader maps the file and a level is used in place,
+// whatever the number of levels in the pack.
+enum PackLevelFlags : uint32_t { kPackDistances = 1, kPackVertices = 2 };
+
+struct PackFileHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t levelCount;
+  uint32_t reserved;
+  uint64_t indexOffset;
+  uint64_t fileSize;
+};
+
+struct PackIndexEntry {
+  uint64_t offset;
+  uint32_t size;
+  uint32_t reserved;
+};
+
+struct PackLevelHeader {
+  // bytes of the level, header and sections
+  uint32_t size;
+  uint32_t flags;
+  int32_t width, height, startX, startY;
+  uint32_t chunkCount, exitCount;
+  // entries of the distances (DistanceField::saveDistances), vertices and indices of the board geometry
+  uint32_t distanceCount, vertexCount, indexCount;
+  // from the start, DistanceField::kUnreachable when unsolvable or stored without distances
+  uint16_t solutionLength;
+  uint16_t reserved;
+  // seed the level was generated from
+  uint64_t seed;
+  uint64_t reserved2;
+};
+
+// one level as seen by the reader, pointing into the mapping
+struct PackedLevel {
+  uint64_t seed{};
+  int width{}, height{};
+  Point start;
+  uint16_t solutionLength{DistanceField::kUnreachable};
+  std::span<const Map::Chunk> chunks;
+  std::span<const uint32_t> directory;
+  std::span<const Point> exits;
+  std::span<const uint64_t> exitKeys;
+  // empty when the level was packed without them
+  std::span<const uint16_t> distances;
+  std::span<const glm::vec3> positions, colors;
+  std::span<const uint32_t> idx;
+
+  // a map reading the level in place, usable while the pack is open
+  [[nodiscard]] Map map() const {
+    return {width, height, start, chunks, directory, exits, exitKeys};
+  }
+};
+
+// writes levels one after another, the index and file header on close
+// not thread-safe
+class LevelPackWriter {
+  public:
+    struct Options {
+      bool distances = true;
+      bool vertices = true;
+    };
+
+    LevelPackWriter() = default;
+    LevelPackWriter(const LevelPackWriter&) = delete;
+    LevelPackWriter& operator=(const LevelPackWriter&) = delete;
+    ~LevelPackWriter();
+    // creates or truncates the file, prints the reason and returns false on failure
+    bool open(const std::string& path, Options options);
+    // field, when given, must be the field of map; without it one is built if the pack keeps distances
+    bool add(const Map& map, uint64_t seed, const DistanceField* field = nullptr);
+    // writes the index and header, false if anything failed since open; a pack not closed does not open
+    bool close();
+    [[nodiscard]] size_t levelCount() const {
+      return index.size();
+    }
+
+  private:
+    bool write(const void* data, size_t size);
+
+    int fd{-1};
+    Options options;
+    uint64_t offset{};
+    std::vector<PackIndexEntry> index;
+    std::vector<char> buffer;
+    std::vector<uint16_t> distances;
+    BoardGeometry board;
+    DistanceField scratchField;
+    bool failed{};
+};
+
+// reads a pack through a read-only mapping of the whole file; nothing is read before a level is asked for
+class LevelPackReader {
+  public:
+    LevelPackReader() = default;
+    LevelPackReader(const LevelPackReader&) = delete;
+    LevelPackReader& operator=(const LevelPackReader&) = delete;
+    ~LevelPackReader();
+    // prints the reason and returns false if the file is missing or not a level pack
+    bool open(const std::string& path);
+    [[nodiscard]] size_t size() const {
+      return header ? header->levelCount : 0;
+    }
+    // level i, checking it lies within the file and fits its map; false for a damaged level
+    bool level(size_t i, PackedLevel& level) const;
+    [[nodiscard]] size_t sizeBytes() const {
+      return length;
+    }
+
+  private:
+    const char* data{};
+    size_t length{};
+    const PackFileHeader* header{};
+    const PackIndexEntry* entries{};
+};
+}
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef CORE_INCLUDE_CORE_MAP_GENERATOR_H_
+#define CORE_INCLUDE_CORE_MAP_GENERATOR_H_
+
+#include <core/map.h>
+#include <core/philox.h>
+#include <cstdint>
+#include <vector>
+
+namespace core {
+struct MapSpec {
+  int numPaths = 1;
+  // path lengths are drawn from [minPathLen, maxPathLen)
+  int minPathLen = 30;
+  int maxPathLen = 50;
+};
+
+// numPaths random walks from a common start, each ending in an exit; a tile walked over twice turns Gray
+// every path draws its length and moves from its own Philox stream (seed, path), so paths are walked
+// independently on worker threads. Each worker folds its paths, in order, into the tile state they leave
+// behind on an empty tile and on a walked one; combining those in path order gives exactly the map a single
+// thread would build, so a seed names the same map at any thread count.
+class MapGenerator {
+  public:
+    // threads <= 0 uses every hardware thread
+    explicit MapGenerator(int threads = 0);
+
+    [[nodiscard]] Map generate(const MapSpec& spec, uint64_t seed) const;
+    // maps for seeds firstSeed, firstSeed + 1, ..., one map per task across the workers
+    [[nodiscard]] std::vector<Map> generateBatch(const MapSpec& spec, uint64_t firstSeed, int count) const;
+    static uint64_t randomSeed();
+
+  private:
+    struct Bounds {
+      int minX{}, maxX{}, minY{}, maxY{};
+    };
+    Map generate(const MapSpec& spec, uint64_t seed, int workers) const;
+    static Bounds pathBounds(const Philox4x32& rng, const MapSpec& spec, int firstPath, int lastPath);
+
+    int threads;
+};
+}
+
+#endif
@@ -0,0 +1,198 @@
+#ifndef CORE_INCLUDE_CORE_MAP_H_
+#define CORE_INCLUDE_CORE_MAP_H_
+
+#include <core/action.h>
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace core {
+struct Point {
+  Point() = default;
+  Point(int x, int y) : x(x), y(y) {
+  }
+  int x{};
+  int y{};
+};
+
+// step taken by the map generator (core/map-generator.h) for Up, Down, Left and Right
+inline const std::array<Point, 4> coordChanges{
+  Point(0, -1),
+  Point(0, 1),
+  Point(-1, 0),
+  Point(1, 0),
+};
+
+enum class TileState : uint8_t { Empty = 0, Gray = 1, Black = 2, White = 3 };
+
+// sparse tile storage for levels grown from random walks, where almost every tile of the bounding box is empty
+// the map is split into 64 x 64 chunks; only chunks holding a non-empty tile are allocated, each as 1 KiB of
+// 2-bit tiles in Morton (Z) order so neighbours share cache lines in both directions. Exits are kept in a
+// sorted key array, and every chunk records whether it holds an exit so most isExit queries are a single
+// directory load.
+// The tiles, directory and exits are read through spans, so a map can also use them in place from memory it
+// does not own (a mapped level pack, core/level-pack.h); the first change copies them into the map.
+class Map {
+  public:
+    static constexpr int kChunkBits = 6;
+    static constexpr int kChunkSize = 1 << kChunkBits;
+    static constexpr int kChunkTiles = kChunkSize * kChunkSize;
+    static constexpr int kTilesPerWord = 32;
+    struct Chunk {
+      std::array<uint64_t, kChunkTiles / kTilesPerWord> words{};
+    };
+    // a directory entry is a chunk number, kNoChunk while its block is all empty, plus kExitFlag
+    static constexpr uint32_t kExitFlag = 1u << 31;
+    static constexpr uint32_t kChunkMask = ~kExitFlag;
+    static constexpr uint32_t kNoChunk = kChunkMask;
+
+    // an empty width x height map
+    Map(int width, int height, Point start);
+    // a map over the arrays of another one (see chunkData and the like), which must outlive it or its first
+    // change; the directory has a uint32 entry per chunk of the map, the exit keys are sorted
+    Map(int width, int height, Point start, std::span<const Chunk> chunks, std::span<const uint32_t> directory,
+        std::span<const Point> exits, std::span<const uint64_t> exitKeys);
+    Map(const Map&) = delete;
+    Map& operator=(const Map&) = delete;
+    Map(Map&&) noexcept = default;
+    Map& operator=(Map&&) noexcept = default;
+
+    [[nodiscard]] TileState tile(int x, int y) const {
+      assert(x >= 0 && x < width && y >= 0 && y < height);
+      uint32_t chunk = directoryView[chunkIndex(x, y)] & kChunkMask;
+      if (chunk == kNoChunk)
+        return TileState::Empty;
+      uint32_t m = morton(x & (kChunkSize - 1), y & (kChunkSize - 1));
+      uint64_t word = chunkView[chunk].words[m / kTilesPerWord];
+      return static_cast<TileState>((word >> (2 * (m % kTilesPerWord))) & 3);
+    }
+    [[nodiscard]] TileState tile(Point p) const {
+      return tile(p.x, p.y);
+    }
+    void setTile(int x, int y, TileState state);
+    void setTile(Point p, TileState state) {
+      setTile(p.x, p.y, state);
+    }
+    [[nodiscard]] bool contains(Point p) const {
+      return p.x >= 0 && p.x < width && p.y >= 0 && p.y < height;
+    }
+
+    // calls fn(x, y, state) for every non-empty tile, chunk by chunk
+    template <typename Fn>
+    void forEachTile(Fn&& fn) const {
+      for (int cx = 0; cx < chunksX; cx++) {
+        for (int cy = 0; cy < chunksY; cy++) {
+          uint32_t chunk = directoryView[static_cast<size_t>(cx) * chunksY + cy] & kChunkMask;
+          if (chunk == kNoChunk)
+            continue;
+          const auto& words = chunkView[chunk].words;
+          for (int w = 0; w < kChunkTiles / kTilesPerWord; w++) {
+            for (uint64_t bits = words[w]; bits;) {
+              int slot = __builtin_ctzll(bits) / 2;
+              bits &= ~(uint64_t{3} << (2 * slot));
+              uint32_t m = w * kTilesPerWord + slot;
+              int x = (cx << kChunkBits) + unspread(m), y = (cy << kChunkBits) + unspread(m >> 1);
+              fn(x, y, static_cast<TileState>((words[w] >> (2 * slot)) & 3));
+            }
+          }
+        }
+      }
+    }
+
+    void getMapInfo() const;
+    [[nodiscard]] Point getStart() const {
+      return start;
+    }
+    [[nodiscard]] int getWidth() const {
+      return width;
+    }
+    [[nodiscard]] int getHeight() const {
+      return height;
+    }
+    // in the order they were added
+    [[nodiscard]] std::span<const Point> getExits() const {
+      return exitView;
+    }
+    void addExit(Point p);
+    [[nodiscard]] bool isExit(int x, int y) const {
+      if (x < 0 || x >= width || y < 0 || y >= height || !(directoryView[chunkIndex(x, y)] & kExitFlag))
+        return false;
+      return std::binary_search(exitKeyView.begin(), exitKeyView.end(), key(x, y));
+    }
+    [[nodiscard]] bool isExit(Point p) const {
+      return isExit(p.x, p.y);
+    }
+    [[nodiscard]] bool isStart(int x, int y) const {
+      return x == start.x && y == start.y;
+    }
+    // bytes held by tiles, the chunk directory and the exits, 0 while they are borrowed
+    [[nodiscard]] size_t memoryBytes() const;
+    [[nodiscard]] size_t chunkCount() const {
+      return chunkView.size();
+    }
+    [[nodiscard]] bool borrowed() const {
+      return isBorrowed;
+    }
+
+    // the arrays behind the map, as a borrowing map takes them
+    [[nodiscard]] std::span<const Chunk> chunkData() const {
+      return chunkView;
+    }
+    [[nodiscard]] std::span<const uint32_t> directoryData() const {
+      return directoryView;
+    }
+    [[nodiscard]] std::span<const uint64_t> exitKeyData() const {
+      return exitKeyView;
+    }
+
+  private:
+
+    // interleave the bits of a 6-bit coordinate so x takes the even and y the odd bits
+    static uint32_t spread(uint32_t v) {
+      v = (v | (v << 4)) & 0x0f0f;
+      v = (v | (v << 2)) & 0x3333;
+      v = (v | (v << 1)) & 0x5555;
+      return v;
+    }
+    static int unspread(uint32_t m) {
+      m &= 0x5555;
+      m = (m | (m >> 1)) & 0x3333;
+      m = (m | (m >> 2)) & 0x0f0f;
+      m = (m | (m >> 4)) & 0x00ff;
+      return static_cast<int>(m);
+    }
+    static uint32_t morton(int x, int y) {
+      return spread(x) | (spread(y) << 1);
+    }
+    [[nodiscard]] size_t chunkIndex(int x, int y) const {
+      return static_cast<size_t>(x >> kChunkBits) * chunksY + (y >> kChunkBits);
+    }
+    static uint64_t key(int x, int y) {
+      return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+    }
+    void allocate(int width, int height);
+    // copies borrowed arrays into the map before a change
+    void own();
+    // points the views at the owned arrays
+    void sync();
+
+    std::vector<Chunk> chunks;
+    // entry of every 64 x 64 block
+    std::vector<uint32_t> directory;
+    std::vector<Point> exits;
+    std::vector<uint64_t> exitKeys;
+    std::span<const Chunk> chunkView;
+    std::span<const uint32_t> directoryView;
+    std::span<const Point> exitView;
+    std::span<const uint64_t> exitKeyView;
+    Point start;
+    int width{}, height{}, chunksX{}, chunksY{};
+    bool isBorrowed{};
+};
+}
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef CORE_INCLUDE_CORE_PHILOX_H_
+#define CORE_INCLUDE_CORE_PHILOX_H_
+
+#include <array>
+#include <cstdint>
+
+namespace core {
+// Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3")
+// a counter-based generator: the output is a pure function of (key, counter), so any worker can draw
+// the numbers of any path or step directly, in any order, and always get the same values
+class Philox4x32 {
+  public:
+    using Block = std::array<uint32_t, 4>;
+
+    explicit Philox4x32(uint64_t seed) : key{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)} {
+    }
+    [[nodiscard]] Block operator()(uint64_t hi, uint64_t lo) const {
+      Block c{static_cast<uint32_t>(lo), static_cast<uint32_t>(lo >> 32), static_cast<uint32_t>(hi),
+              static_cast<uint32_t>(hi >> 32)};
+      uint32_t k0 = key[0], k1 = key[1];
+      for (int round = 0; round < 10; round++) {
+        uint64_t p0 = static_cast<uint64_t>(kMul0) * c[0];
+        uint64_t p1 = static_cast<uint64_t>(kMul1) * c[2];
+        c = {static_cast<uint32_t>(p1 >> 32) ^ c[1] ^ k0, static_cast<uint32_t>(p1),
+             static_cast<uint32_t>(p0 >> 32) ^ c[3] ^ k1, static_cast<uint32_t>(p0)};
+        k0 += kWeyl0;
+        k1 += kWeyl1;
+      }
+      return c;
+    }
+    // a value in [0, n) from 32 random bits, by multiply and shift instead of a biased modulo
+    static uint32_t below(uint32_t bits, uint32_t n) {
+      return static_cast<uint32_t>((static_cast<uint64_t>(bits) * n) >> 32);
+    }
+
+  private:
+    static constexpr uint32_t kMul0 = 0xD2511F53, kMul1 = 0xCD9E8D57;
+    static constexpr uint32_t kWeyl0 = 0x9E3779B9, kWeyl1 = 0xBB67AE85;
+    std::array<uint32_t, 2> key;
+};
+}
+
+#endif
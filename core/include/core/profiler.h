@@ -0,0 +1,113 @@
+#ifndef CORE_INCLUDE_CORE_PROFILER_H_
+#define CORE_INCLUDE_CORE_PROFILER_H_
+
+#include <core/event-ring.h>
+#include <core/timing.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// zones are compiled in unless the build sets HCI_PROFILING=0 (cmake -DHCI_PROFILING=OFF); compiled out,
+// HCI_PROFILE_ZONE expands to nothing and costs nothing
+#ifndef HCI_PROFILING
+#define HCI_PROFILING 1
+#endif
+
+namespace core {
+// timeline of named zones from every thread (and from measurements made elsewhere, like GPU timer queries),
+// written out as a Chrome trace for chrome://tracing or ui.perfetto.dev
+// recording is off until start(); while off a zone costs one relaxed load. While on, a zone is pushed into a
+// lock-free ring owned by its thread, which collect() empties from any thread, often enough that the rings
+// do not overflow (once per frame); zones that found their ring full are counted as dropped.
+class Profiler {
+  public:
+    static Profiler& instance();
+
+    void start();
+    void stop();
+    [[nodiscard]] bool enabled() const {
+      return on.load(std::memory_order_relaxed);
+    }
+
+    // on the calling thread's track; name must outlive the profiler, e.g. a string literal
+    void record(const char* name, int64_t beginNs, int64_t endNs);
+    // on a track of its own called track, e.g. "GPU"
+    void record(const char* track, const char* name, int64_t beginNs, int64_t endNs);
+    // shown as the calling thread's name
+    void nameThread(const std::string& name);
+
+    void collect();
+    // forgets the zones collected so far
+    void clear();
+    // collects first; false when the file cannot be written
+    bool writeChromeTrace(const std::string& path);
+    [[nodiscard]] size_t zoneCount();
+    [[nodiscard]] uint64_t dropped() const;
+
+  private:
+    struct Record {
+      const char* name;
+      // null on the thread's own track
+      const char* track;
+      int64_t beginNs;
+    };
+    static constexpr size_t kRingCapacity = 8192;
+    struct ThreadBuffer {
+      EventRing<Record, kRingCapacity> ring;
+      int tid;
+      std::string name;
+    };
+    struct Zone {
+      const char* name;
+      int tid;
+      int64_t beginNs, endNs;
+    };
+
+    ThreadBuffer& local();
+    int trackId(const char* track);
+
+    std::atomic_bool on{false};
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> threads;
+    std::vector<std::string> tracks;
+    std::vector<Zone> zones;
+};
+
+// records the enclosing scope as a zone on the calling thread's track
+class ScopedZone {
+  public:
+    explicit ScopedZone(const char* name)
+      : name(name), beginNs(Profiler::instance().enabled() ? monotonicNs() : 0) {
+    }
+    ScopedZone(const ScopedZone&) = delete;
+    ScopedZone& operator=(const ScopedZone&) = delete;
+    ~ScopedZone() {
+      if (beginNs)
+        Profiler::instance().record(name, beginNs, monotonicNs());
+    }
+
+  private:
+    const char* name;
+    int64_t beginNs;
+};
+}
+
+#define HCI_PROFILE_CONCAT_(a, b) a##b
+#define HCI_PROFILE_CONCAT(a, b) HCI_PROFILE_CONCAT_(a, b)
+#if HCI_PROFILING
+#define HCI_PROFILE_ZONE(name) ::core::ScopedZone HCI_PROFILE_CONCAT(hciProfileZone, __LINE__)(name)
+// names the calling thread's track while recording
+#define HCI_PROFILE_THREAD(name) \
+  do { \
+    if (::core::Profiler::instance().enabled()) \
+      ::core::Profiler::instance().nameThread(name); \
+  } while (0)
+#else
+#define HCI_PROFILE_ZONE(name) static_cast<void>(0)
+#define HCI_PROFILE_THREAD(name) static_cast<void>(0)
+#endif
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef CORE_INCLUDE_CORE_SERIAL_READER_H_
+#define CORE_INCLUDE_CORE_SERIAL_READER_H_
+
+#include <core/event-ring.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace core {
+// 21 hand keypoints as (x, y) pairs, the layout the tracking device emits
+inline constexpr int kKeypointDim = 42;
+using KeypointFrame = std::array<float, kKeypointDim>;
+
+// incremental parser for the device's "[x0,y0,x1,y1,...]" text frames
+// bytes can be fed in arbitrarily sized pieces; anything outside a bracket pair is ignored
+class KeypointParser {
+  public:
+    // parse as many complete frames as possible from data, calling onFrame for each
+    // returns the number of bytes consumed; the unconsumed tail is the start of an incomplete frame
+    template <typename Fn>
+    size_t parse(const char* data, size_t len, Fn&& onFrame) {
+      const char* p = data;
+      const char* end = data + len;
+      for (;;) {
+        auto* open = static_cast<const char*>(memchr(p, '[', end - p));
+        if (!open)
+          return len;
+        auto* close = static_cast<const char*>(memchr(open + 1, ']', end - open - 1));
+        if (!close)
+          return open - data;
+        // a '[' inside the frame means we resynchronised in the middle of one, restart there
+        if (auto* reopen = static_cast<const char*>(memchr(open + 1, '[', close - open - 1))) {
+          malformed++;
+          p = reopen;
+          continue;
+        }
+        if (parseFrame(open + 1, close, frame))
+          onFrame(static_cast<const KeypointFrame&>(frame));
+        else
+          malformed++;
+        p = close + 1;
+      }
+    }
+    [[nodiscard]] uint64_t malformedCount() const {
+      return malformed;
+    }
+    // parse the comma separated body of one frame, without brackets
+    static bool parseFrame(const char* begin, const char* end, KeypointFrame& out);
+
+  private:
+    KeypointFrame frame{};
+    uint64_t malformed{};
+};
+
+// reads keypoint frames from the hand tracking device (or anything that looks like a tty)
+// on its own thread and publishes them, stamped at the read that completed them, into frames
+class SerialKeypointReader {
+  public:
+    explicit SerialKeypointReader(std::string device, int baudRate = 115200);
+    SerialKeypointReader(const SerialKeypointReader&) = delete;
+    SerialKeypointReader& operator=(const SerialKeypointReader&) = delete;
+    ~SerialKeypointReader();
+    // open and configure the tty in raw mode, prints the reason on failure
+    bool open();
+    // take over an already opened descriptor, e.g. a pipe or the slave end of a pseudo-terminal
+    void attach(int fd);
+    void start();
+    void stop();
+    [[nodiscard]] bool isOpen() const {
+      return fd >= 0;
+    }
+    [[nodiscard]] bool finished() const {
+      return eof.load(std::memory_order_acquire);
+    }
+    [[nodiscard]] uint64_t malformedCount() const {
+      return malformed.load(std::memory_order_relaxed);
+    }
+    [[nodiscard]] uint64_t bytesRead() const {
+      return totalBytes.load(std::memory_order_relaxed);
+    }
+    EventRing<KeypointFrame, 64> frames;
+
+  private:
+    void readLoop();
+    std::string device;
+    int baudRate;
+    int fd{-1};
+    std::atomic_bool running{false};
+    std::atomic_bool eof{false};
+    std::atomic<uint64_t> malformed{0};
+    std::atomic<uint64_t> totalBytes{0};
+    std::unique_ptr<std::thread> thread;
+};
+
+// create a pseudo-terminal pair; returns the master descriptor and stores the slave's path
+// the slave can then be handed to SerialKeypointReader in place of the real device
+int openPseudoTerminal(std::string& slavePath);
+}
+
+#endif
@@ -0,0 +1,118 @@
+#ifndef CORE_INCLUDE_CORE_SESSION_LOG_H_
+#define CORE_INCLUDE_CORE_SESSION_LOG_H_
+
+#include <core/action.h>
+#include <core/serial-reader.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace core {
+// binary session log: a 16 byte file header followed by records, each a 16 byte header and a payload
+// padded to 8 bytes, so the reader can use every record in place from the mapping
+enum class LogRecordType : uint8_t { Keypoints = 1, Gesture = 2, Action = 3 };
+
+struct LogFileHeader {
+  char magic[4];
+  uint32_t version;
+  // monotonic time the session started
+  int64_t startNs;
+};
+
+struct LogRecordHeader {
+  LogRecordType type;
+  // ActionStatus of gesture and action records
+  uint8_t status;
+  uint16_t size;
+  uint32_t seq;
+  // capture time of the keypoint frame the record belongs to
+  int64_t timeNs;
+};
+
+struct LogGesture {
+  int32_t gesture;
+  float confidence;
+};
+
+struct LogAction {
+  Action action;
+  uint8_t reserved[7];
+  int64_t emitNs;
+};
+
+// one record as seen by the reader, pointing into the mapping
+struct LogRecord {
+  LogRecordType type;
+  ActionStatus status;
+  uint32_t seq;
+  int64_t timeNs;
+  // 42 floats for keypoint records
+  const float* keypoints;
+  LogGesture gesture;
+  ActionEvent action;
+};
+
+// append-only writer; records are buffered and written in large blocks
+// not thread-safe, each log is written by the thread that produces its events
+class SessionLogWriter {
+  public:
+    SessionLogWriter() = default;
+    SessionLogWriter(const SessionLogWriter&) = delete;
+    SessionLogWriter& operator=(const SessionLogWriter&) = delete;
+    ~SessionLogWriter();
+    // creates or truncates the file, prints the reason and returns false on failure
+    bool open(const std::string& path);
+    void writeFrame(int64_t captureNs, const KeypointFrame& frame);
+    void writeGesture(int64_t captureNs, int gesture, float confidence, ActionStatus status);
+    void writeAction(int64_t captureNs, const ActionEvent& event);
+    bool flush();
+    void close();
+    [[nodiscard]] bool isOpen() const {
+      return fd >= 0;
+    }
+    [[nodiscard]] uint64_t recordCount() const {
+      return seq;
+    }
+
+  private:
+    void append(LogRecordType type, uint8_t status, int64_t timeNs, const void* payload, size_t size);
+
+    static constexpr size_t kBufferSize = 1 << 16;
+    int fd{-1};
+    uint32_t seq{};
+    std::vector<char> buffer;
+    bool failed{};
+};
+
+// reads a log through a read-only mapping of the whole file
+class SessionLogReader {
+  public:
+    SessionLogReader() = default;
+    SessionLogReader(const SessionLogReader&) = delete;
+    SessionLogReader& operator=(const SessionLogReader&) = delete;
+    ~SessionLogReader();
+    // prints the reason and returns false if the file is missing or not a session log
+    bool open(const std::string& path);
+    // the next record, false at the end of the log; a record cut short by a crash ends the log
+    bool next(LogRecord& record);
+    void rewind();
+    [[nodiscard]] int64_t startNs() const {
+      return header ? header->startNs : 0;
+    }
+    [[nodiscard]] size_t sizeBytes() const {
+      return length;
+    }
+    [[nodiscard]] bool truncated() const {
+      return cut;
+    }
+
+  private:
+    const char* data{};
+    size_t length{}, offset{};
+    const LogFileHeader* header{};
+    bool cut{};
+};
+}
+
+#endif
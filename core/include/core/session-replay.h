@@ -0,0 +1,49 @@
+#ifndef CORE_INCLUDE_CORE_SESSION_REPLAY_H_
+#define CORE_INCLUDE_CORE_SESSION_REPLAY_H_
+
+#include <core/gesture-pipeline.h>
+#include <core/input-adapter.h>
+#include <core/session-log.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace core {
+struct ReplayOptions {
+  // 1 keeps the recorded pace, 10 is ten times faster, 0 goes as fast as the consumer takes actions
+  double speed = 1.0;
+  // run the recorded keypoint frames through the classifier again instead of replaying the recorded actions
+  bool reclassify = false;
+  std::string weights;
+  SpeculativeGestureDetector::Config detector;
+};
+
+// plays a session log back into the game like a live input source
+// replayed events are stamped with the time they are replayed at, so latency tracing stays meaningful
+class ReplayAdapter final : public InputAdapter {
+  public:
+    explicit ReplayAdapter(ReplayOptions options);
+    ~ReplayAdapter() noexcept override;
+    // map the log (and load the model when reclassifying), prints the reason on failure
+    bool open(const std::string& path);
+    void start();
+    void inputAction() override;
+    [[nodiscard]] bool finished() const {
+      return done.load(std::memory_order_acquire);
+    }
+
+  private:
+    // block until the consumer has made room for count actions
+    bool waitForRoom(int count);
+
+    ReplayOptions options;
+    SessionLogReader reader;
+    GestureModel model;
+    std::unique_ptr<GesturePipeline> pipeline;
+    std::atomic_bool running{true}, done{false};
+    std::unique_ptr<std::thread> thread;
+};
+}
+
+#endif
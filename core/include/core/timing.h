@@ -0,0 +1,46 @@
+#ifndef CORE_INCLUDE_CORE_TIMING_H_
+#define CORE_INCLUDE_CORE_TIMING_H_
+
+#include <chrono>
+#include <cstdint>
+
+namespace core {
+// nanoseconds on the monotonic clock, used to stamp every input event at capture time
+inline int64_t monotonicNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// seconds on some clock; game logic reads time only through a Clock so it can run without a window, and
+// faster or slower than real time
+class Clock {
+  public:
+    virtual ~Clock() = default;
+    [[nodiscard]] virtual double now() const = 0;
+};
+
+class SteadyClock final : public Clock {
+  public:
+    [[nodiscard]] double now() const override {
+      return static_cast<double>(monotonicNs()) / 1e9;
+    }
+};
+
+// time only moves when told to, for simulations and tests
+class ManualClock final : public Clock {
+  public:
+    explicit ManualClock(double start = 0.0) : time(start) {
+    }
+    [[nodiscard]] double now() const override {
+      return time;
+    }
+    void advance(double seconds) {
+      time += seconds;
+    }
+
+  private:
+    double time;
+};
+}
+
+#endif
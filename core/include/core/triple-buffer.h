@@ -0,0 +1,58 @@
+#ifndef CORE_INCLUDE_CORE_TRIPLE_BUFFER_H_
+#define CORE_INCLUDE_CORE_TRIPLE_BUFFER_H_
+
+#include <core/event-ring.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace core {
+// hands the newest value from one writer thread to one reader thread
+// the writer fills the back slot and publishes it by swapping it with the middle one; the reader swaps the
+// middle slot with its front slot when something new was published. Neither side ever waits for the other,
+// and values the reader did not get to in time are overwritten.
+template <typename T>
+class TripleBuffer {
+  public:
+    TripleBuffer() = default;
+    explicit TripleBuffer(const T& initial) {
+      for (auto& slot : slots)
+        slot.value = initial;
+    }
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // writer side
+    T& back() {
+      return slots[backIndex].value;
+    }
+    void publish() {
+      backIndex = middle.exchange(backIndex | kFresh, std::memory_order_acq_rel) & kIndexMask;
+    }
+
+    // reader side: moves to the newest published value, false when there was nothing new
+    bool acquire() {
+      if (!(middle.load(std::memory_order_relaxed) & kFresh))
+        return false;
+      frontIndex = middle.exchange(frontIndex, std::memory_order_acq_rel) & kIndexMask;
+      return true;
+    }
+    [[nodiscard]] const T& front() const {
+      return slots[frontIndex].value;
+    }
+
+  private:
+    static constexpr uint8_t kIndexMask = 3;
+    static constexpr uint8_t kFresh = 4;
+    struct alignas(kCacheLineSize) Slot {
+      T value{};
+    };
+
+    std::array<Slot, 3> slots{};
+    alignas(kCacheLineSize) uint8_t backIndex{0};
+    alignas(kCacheLineSize) std::atomic<uint8_t> middle{1};
+    alignas(kCacheLineSize) uint8_t frontIndex{2};
+};
+}
+
+#endif
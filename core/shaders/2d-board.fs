@@ -0,0 +1,16 @@
+#version 330 core
+
+// one texel per tile: the TileState, plus 4 on an exit
+uniform usampler2D uTiles;
+in vec2 mapPos;
+out vec4 fragColor;
+
+// Empty (not drawn), Gray, Black, White, then exit
+const vec3 kColors[5] = vec3[5](vec3(0.0f), vec3(0.5f), vec3(0.0f), vec3(1.0f), vec3(0.0f, 1.0f, 0.0f));
+
+void main() {
+  uint cell = texelFetch(uTiles, ivec2(mapPos), 0).r;
+  if (cell == 0u)
+    discard;
+  fragColor = vec4(kColors[(cell & 4u) != 0u ? 4u : cell], 1.0f);
+}
@@ -0,0 +1,11 @@
+#version 330 core
+
+// a quad over the whole viewport, drawn as a 4 vertex strip without any vertex data
+uniform vec2 uMapSize;
+out vec2 mapPos;
+
+void main() {
+  vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+  mapPos = corner * uMapSize;
+  gl_Position = vec4(corner * 2.0f - 1.0f, 0.0f, 1.0f);
+}
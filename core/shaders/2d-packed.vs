@@ -0,0 +1,12 @@
+#version 330 core
+
+// a board corner as whole tiles (x, y) and its depth in halves (z), with an RGBA8 color
+layout (location = 0) in vec4 aPos;
+layout (location = 1) in vec4 aColor;
+uniform vec2 uMapSize;
+out vec3 myColor;
+
+void main() {
+  myColor = aColor.rgb;
+  gl_Position = vec4(aPos.xy / uMapSize * 2.0f - 1.0f, aPos.z * 0.5f, 1.0f);
+}
@@ -0,0 +1,8 @@
+#version 330 core
+
+in vec3 myColor;
+out vec4 fragColor;
+
+void main() {
+  fragColor = vec4(myColor, 1.0f);
+}
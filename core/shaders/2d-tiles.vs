@@ -0,0 +1,19 @@
+#version 330 core
+
+// one instance per tile: a corner of the unit square, the tile's position in tiles and what it shows
+layout (location = 0) in vec2 aCorner;
+layout (location = 1) in vec2 aTile;
+layout (location = 2) in uint aKind;
+uniform vec2 uMapSize;
+out vec3 myColor;
+
+// Gray, Black, White tiles, exit, then the block when Black and when White
+const vec3 kColors[7] = vec3[7](vec3(0.0f), vec3(0.5f), vec3(0.0f), vec3(1.0f), vec3(0.0f, 1.0f, 0.0f),
+                                vec3(1.0f, 0.0f, 0.0f), vec3(0.0f, 0.0f, 1.0f));
+
+void main() {
+  myColor = kColors[aKind];
+  // exits and the block are drawn in front of the tiles
+  float z = aKind >= 4u ? -0.5f : 0.0f;
+  gl_Position = vec4(-1.0f + (aTile + aCorner) * 2.0f / uMapSize, z, 1.0f);
+}
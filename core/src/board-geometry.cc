@@ -0,0 +1,51 @@
+#include <core/board-geometry.h>
+
+namespace core {
+void BoardGeometry::addSquare(float x, float y, float z, float width, float height, const glm::vec3& color) {
+  auto first = static_cast<uint32_t>(positions.size());
+  positions.emplace_back(x, y, z);
+  positions.emplace_back(x + width, y, z);
+  positions.emplace_back(x + width, y + height, z);
+  positions.emplace_back(x, y + height, z);
+  for (int i = 0; i < 4; ++i)
+    colors.push_back(color);
+  idx.push_back(first);
+  idx.push_back(first + 1);
+  idx.push_back(first + 2);
+  idx.push_back(first);
+  idx.push_back(first + 2);
+  idx.push_back(first + 3);
+}
+
+void BoardGeometry::addTiles(const Map& map) {
+  auto width = static_cast<float>(map.getWidth()), height = static_cast<float>(map.getHeight());
+  map.forEachTile([&](int i, int j, TileState state) {
+    glm::vec3 squareColor;
+    glm::vec3 squarePosition;
+    squarePosition.x = -1.0f + static_cast<float>(i) / width * 2.0f; // Set x position based on column index
+    squarePosition.y = -1.0f + static_cast<float>(j) / height * 2.0f; // Set y position based on row index
+    squarePosition.z = 0.0f;
+    if (map.isExit(i, j)) {
+      squareColor = glm::vec3(0.0f, 1.0f, 0.0f);
+      squarePosition.z = -0.5f;
+    }
+    else if (state == TileState::Black)
+      squareColor = glm::vec3(0.0f, 0.0f, 0.0f);
+    else if (state == TileState::Gray)
+      squareColor = glm::vec3(0.5f, 0.5f, 0.5f);
+    else if (state == TileState::White)
+      squareColor = glm::vec3(1.0f, 1.0f, 1.0f);
+    addSquare(squarePosition.x, squarePosition.y, squarePosition.z, 2.0f / width, 2.0f / height, squareColor);
+  });
+}
+
+void BoardGeometry::append(std::span<const glm::vec3> addedPositions, std::span<const glm::vec3> addedColors,
+                           std::span<const uint32_t> addedIdx) {
+  auto first = static_cast<uint32_t>(positions.size());
+  positions.insert(positions.end(), addedPositions.begin(), addedPositions.end());
+  colors.insert(colors.end(), addedColors.begin(), addedColors.end());
+  idx.reserve(idx.size() + addedIdx.size());
+  for (uint32_t i : addedIdx)
+    idx.push_back(first + i);
+}
+}
@@ -0,0 +1,224 @@
+#include <core/distance-field.h>
+#include <core/game-state.h>
+#include <algorithm>
+
+namespace core {
+template <typename Fn>
+void DistanceField::forEachSuccessor(uint32_t s, Fn&& fn) const {
+  Point p = position(s);
+  int color = static_cast<int>(s & 1);
+  for (const Point& step : moveSteps) {
+    uint32_t t = state(p.x + step.x, p.y + step.y, color);
+    // an exit ends the game before its tile is looked at
+    if (t != kNoState && ((cell(t) & kExitBit) || live(cell(t), color)))
+      fn(t);
+  }
+  if ((cell(s) & kTileMask) == static_cast<uint8_t>(TileState::Gray))
+    fn(s ^ 1);
+}
+
+template <typename Fn>
+void DistanceField::forEachPredecessor(uint32_t s, Fn&& fn) const {
+  Point q = position(s);
+  int color = static_cast<int>(s & 1);
+  uint8_t here = cell(s);
+  if ((here & kExitBit) || live(here, color)) {
+    for (const Point& step : moveSteps) {
+      uint32_t p = state(q.x - step.x, q.y - step.y, color);
+      if (p != kNoState && live(cell(p), color) && !(cell(p) & kExitBit))
+        fn(p);
+    }
+  }
+  // a Gray exit is left out with the other exits, the game ends there
+  if (here == static_cast<uint8_t>(TileState::Gray))
+    fn(s ^ 1);
+}
+
+uint16_t DistanceField::settle(uint32_t s) const {
+  uint8_t here = cell(s);
+  if (here & kExitBit)
+    return 0;
+  if (!live(here, static_cast<int>(s & 1)))
+    return kUnreachable;
+  uint16_t best = kUnreachable;
+  forEachSuccessor(s, [&](uint32_t t) { best = std::min(best, dist(t)); });
+  return best == kUnreachable ? kUnreachable : std::min<uint16_t>(best + 1, kFar);
+}
+
+void DistanceField::allocate(int x, int y) {
+  uint32_t& chunk = directory[static_cast<size_t>(x >> Map::kChunkBits) * chunksY + (y >> Map::kChunkBits)];
+  if (chunk != kNoChunk)
+    return;
+  chunk = static_cast<uint32_t>(chunks.size());
+  Chunk& added = chunks.emplace_back();
+  added.dist.fill(kUnreachable);
+  added.cells.fill(0);
+  origins.emplace_back(x & ~(Map::kChunkSize - 1), y & ~(Map::kChunkSize - 1));
+}
+
+void DistanceField::load(const Map& map, int x, int y) {
+  uint32_t s = state(x, y, 0);
+  if (s != kNoState)
+    cell(s) = static_cast<uint8_t>(map.tile(x, y)) | (map.isExit(x, y) ? kExitBit : 0);
+}
+
+void DistanceField::layout(const Map& map) {
+  width = map.getWidth();
+  height = map.getHeight();
+  start = map.getStart();
+  chunksY = (height + Map::kChunkSize - 1) >> Map::kChunkBits;
+  int chunksX = (width + Map::kChunkSize - 1) >> Map::kChunkBits;
+  directory.assign(static_cast<size_t>(chunksX) * chunksY, kNoChunk);
+  chunks.clear();
+  origins.clear();
+  map.forEachTile([&](int x, int y, TileState tile) {
+    allocate(x, y);
+    cell(state(x, y, 0)) = static_cast<uint8_t>(tile);
+  });
+  for (auto exit : map.getExits())
+    load(map, exit.x, exit.y);
+}
+
+void DistanceField::build(const Map& map) {
+  layout(map);
+  queue.clear();
+  for (auto exit : map.getExits()) {
+    for (int color = 0; color < 2; color++) {
+      uint32_t s = state(exit.x, exit.y, color);
+      dist(s) = 0;
+      queue.push_back(s);
+    }
+  }
+  propagate();
+}
+
+bool DistanceField::restore(const Map& map, std::span<const uint16_t> distances) {
+  layout(map);
+  // chunks and tiles are visited in the same order as saveDistances does, the same for the same map
+  size_t n = 0;
+  for (auto& chunk : chunks) {
+    for (int t = 0; t < Map::kChunkTiles; t++) {
+      if (!(chunk.cells[t] & kTileMask))
+        continue;
+      if (n + 2 > distances.size())
+        return false;
+      chunk.dist[2 * t] = distances[n++];
+      chunk.dist[2 * t + 1] = distances[n++];
+    }
+  }
+  return n == distances.size();
+}
+
+void DistanceField::saveDistances(std::vector<uint16_t>& out) const {
+  out.clear();
+  for (const auto& chunk : chunks) {
+    for (int t = 0; t < Map::kChunkTiles; t++) {
+      if (chunk.cells[t] & kTileMask) {
+        out.push_back(chunk.dist[2 * t]);
+        out.push_back(chunk.dist[2 * t + 1]);
+      }
+    }
+  }
+}
+
+void DistanceField::propagate() {
+  // a state is queued whenever its distance drops; from the exits alone this is a plain breadth-first
+  // search, after an update a state may be improved (and expanded) more than once
+  for (size_t head = 0; head < queue.size(); head++) {
+    uint32_t s = queue[head];
+    uint16_t next = std::min<uint16_t>(dist(s) + 1, kFar);
+    forEachPredecessor(s, [&](uint32_t p) {
+      if (dist(p) > next) {
+        dist(p) = next;
+        queue.push_back(p);
+      }
+    });
+  }
+  queue.clear();
+}
+
+void DistanceField::update(const Map& map, std::span<const Point> changed) {
+  queue.clear();
+  for (auto p : changed) {
+    if (!map.contains(p))
+      continue;
+    if (map.tile(p) != TileState::Empty)
+      allocate(p.x, p.y);
+    load(map, p.x, p.y);
+    for (int color = 0; color < 2; color++) {
+      uint32_t s = state(p.x, p.y, color);
+      if (s != kNoState)
+        queue.push_back(s);
+    }
+  }
+
+  // a state no longer backed by a successor one step closer loses its distance, and so may every state
+  // that was one step further out through it, whether or not it can still enter it
+  raised.clear();
+  for (size_t head = 0; head < queue.size(); head++) {
+    uint32_t s = queue[head];
+    uint16_t d = dist(s);
+    if (d == kUnreachable || settle(s) <= d)
+      continue;
+    dist(s) = kUnreachable;
+    raised.push_back(s);
+    Point q = position(s);
+    int color = static_cast<int>(s & 1);
+    for (const Point& step : moveSteps) {
+      uint32_t p = state(q.x - step.x, q.y - step.y, color);
+      if (p != kNoState && dist(p) != kUnreachable && dist(p) > d)
+        queue.push_back(p);
+    }
+    if (dist(s ^ 1) != kUnreachable && dist(s ^ 1) > d)
+      queue.push_back(s ^ 1);
+  }
+
+  // then everything touched takes the best distance its successors offer and passes improvements on
+  queue.insert(queue.end(), raised.begin(), raised.end());
+  size_t kept = 0;
+  for (size_t i = 0; i < queue.size(); i++) {
+    uint32_t s = queue[i];
+    uint16_t d = settle(s);
+    if (d < dist(s)) {
+      dist(s) = d;
+      queue[kept++] = s;
+    }
+  }
+  queue.resize(kept);
+  propagate();
+}
+
+bool DistanceField::hint(Point p, TileState color, Action& action) const {
+  int c = color == TileState::White;
+  uint32_t s = state(p.x, p.y, c);
+  if (s == kNoState || (cell(s) & kExitBit) || !live(cell(s), c) || dist(s) == kUnreachable)
+    return false;
+  uint16_t d = dist(s);
+  for (int i = 0; i < 4; i++) {
+    uint32_t t = state(p.x + moveSteps[i].x, p.y + moveSteps[i].y, c);
+    if (t == kNoState || !((cell(t) & kExitBit) || live(cell(t), c)))
+      continue;
+    if (dist(t) < d) {
+      action = static_cast<Action>(i);
+      return true;
+    }
+  }
+  if ((cell(s) & kTileMask) == static_cast<uint8_t>(TileState::Gray) && dist(s ^ 1) < d) {
+    action = Action::Switch;
+    return true;
+  }
+  return false;
+}
+
+size_t DistanceField::reachableStates() const {
+  size_t count = 0;
+  for (const auto& chunk : chunks)
+    count += chunk.dist.size() - std::count(chunk.dist.begin(), chunk.dist.end(), kUnreachable);
+  return count;
+}
+
+size_t DistanceField::memoryBytes() const {
+  return chunks.capacity() * sizeof(Chunk) + origins.capacity() * sizeof(Point)
+         + directory.capacity() * sizeof(uint32_t) + (queue.capacity() + raised.capacity()) * sizeof(uint32_t);
+}
+}
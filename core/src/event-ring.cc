@@ -0,0 +1,45 @@
+#include <core/event-ring.h>
+#include <climits>
+#include <thread>
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <ctime>
+#endif
+
+namespace core::detail {
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be a plain 32-bit integer");
+
+#if defined(__linux__)
+void futexWait(std::atomic<uint32_t>& word, uint32_t expected, int64_t timeoutNs) {
+  timespec ts{};
+  timespec* pts = nullptr;
+  if (timeoutNs >= 0) {
+    ts.tv_sec = timeoutNs / 1000000000;
+    ts.tv_nsec = timeoutNs % 1000000000;
+    pts = &ts;
+  }
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, pts, nullptr, 0);
+}
+
+void futexWakeAll(std::atomic<uint32_t>& word) {
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+}
+#else
+void futexWait(std::atomic<uint32_t>& word, uint32_t expected, int64_t timeoutNs) {
+  if (timeoutNs < 0) {
+    word.wait(expected, std::memory_order_relaxed);
+    return;
+  }
+  // std::atomic::wait has no timeout, poll at a coarse granularity instead
+  int64_t deadline = monotonicNs() + timeoutNs;
+  while (word.load(std::memory_order_relaxed) == expected && monotonicNs() < deadline)
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+}
+
+void futexWakeAll(std::atomic<uint32_t>& word) {
+  word.notify_all();
+}
+#endif
+}
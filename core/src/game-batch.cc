@@ -0,0 +1,144 @@
+#include <core/game-batch.h>
+#include <algorithm>
+#include <thread>
+
+namespace core {
+namespace {
+constexpr auto kRunning = static_cast<uint8_t>(GameEnd::Running);
+constexpr auto kFinished = static_cast<uint8_t>(GameEnd::Finished);
+constexpr auto kFailed = static_cast<uint8_t>(GameEnd::Failed);
+constexpr auto kGray = static_cast<uint8_t>(TileState::Gray);
+constexpr auto kUp = static_cast<uint8_t>(Action::Up), kDown = static_cast<uint8_t>(Action::Down);
+constexpr auto kLeft = static_cast<uint8_t>(Action::Left), kRight = static_cast<uint8_t>(Action::Right);
+constexpr auto kSwitch = static_cast<uint8_t>(Action::Switch);
+
+// GameState::move without branches: Up and Down step along x, Left and Right along y, Switch flips Black (2)
+// and White (3); finished games and idle ones stay as they are. Plain arrays the compiler knows do not
+// overlap, so the loop vectorizes (at -O3, the Release default).
+void moveGames(int count, const uint8_t* __restrict action, const uint8_t* __restrict ending,
+               int32_t* __restrict x, int32_t* __restrict y, uint8_t* __restrict color, int32_t* __restrict moved,
+               uint8_t idle) {
+  for (int i = 0; i < count; i++) {
+    int32_t a = action[i];
+    // all ones for a running game, masks rather than multiplies so every step is a vector compare or and
+    int32_t live = -static_cast<int32_t>(ending[i] == kRunning);
+    x[i] += live & (static_cast<int32_t>(a == kDown) - static_cast<int32_t>(a == kUp));
+    y[i] += live & (static_cast<int32_t>(a == kRight) - static_cast<int32_t>(a == kLeft));
+    color[i] ^= static_cast<uint8_t>(live & static_cast<int32_t>(a == kSwitch));
+    moved[i] += live & static_cast<int32_t>(a != idle);
+  }
+}
+}
+
+int GameBatch::addLevel(const Map& map) {
+  Level level;
+  level.width = map.getWidth();
+  level.height = map.getHeight();
+  level.start = map.getStart();
+  level.cells.assign(static_cast<size_t>(level.width) * level.height, 0);
+  map.forEachTile([&](int x, int y, TileState state) {
+    level.cells[static_cast<size_t>(x) * level.height + y] = static_cast<uint8_t>(state);
+  });
+  for (auto exit : map.getExits())
+    level.cells[static_cast<size_t>(exit.x) * level.height + exit.y] |= kExitBit;
+  levels.push_back(std::move(level));
+  return static_cast<int>(levels.size()) - 1;
+}
+
+int GameBatch::addGame(int level, double now) {
+  Point start = levels[level].start;
+  xs.push_back(start.x);
+  ys.push_back(start.y);
+  moves.push_back(0);
+  levelOf.push_back(level);
+  colors.push_back(static_cast<uint8_t>(TileState::Black));
+  endings.push_back(kRunning);
+  startTimes.push_back(now);
+  lastTimes.push_back(now);
+  // GameSimulation checks the rules before the first action too, a start on an exit is finished at once
+  int game = size() - 1;
+  checkRules(game, game + 1, now);
+  return game;
+}
+
+void GameBatch::reset(double now) {
+  for (int i = 0; i < size(); i++) {
+    xs[i] = levels[levelOf[i]].start.x;
+    ys[i] = levels[levelOf[i]].start.y;
+  }
+  std::fill(moves.begin(), moves.end(), 0);
+  std::fill(colors.begin(), colors.end(), static_cast<uint8_t>(TileState::Black));
+  std::fill(endings.begin(), endings.end(), kRunning);
+  std::fill(startTimes.begin(), startTimes.end(), now);
+  std::fill(lastTimes.begin(), lastTimes.end(), now);
+  checkRules(0, size(), now);
+}
+
+int GameBatch::step(int begin, int end, const uint8_t* actions, double now) {
+  moveGames(end - begin, actions, &endings[begin], &xs[begin], &ys[begin], &colors[begin], &moves[begin], kIdle);
+  return checkRules(begin, end, now);
+}
+
+int GameBatch::checkRules(int begin, int end, double now) {
+  const int32_t* x = xs.data();
+  const int32_t* y = ys.data();
+  const uint8_t* color = colors.data();
+  uint8_t* ending = endings.data();
+
+  // GameState::update: a tile that is not Gray must match the block's color (Empty never does), an exit
+  // finishes the game whatever else happened, and so does running out of time
+  int running = 0;
+  for (int i = begin; i < end; i++) {
+    if (ending[i] != kRunning)
+      continue;
+    uint8_t here = cell(levelOf[i], x[i], y[i]);
+    uint8_t tile = here & kTileMask;
+    uint8_t next = tile != kGray && tile != color[i] ? kFailed : kRunning;
+    if ((here & kExitBit) || now > startTimes[i] + kMaxGameTime)
+      next = kFinished;
+    ending[i] = next;
+    lastTimes[i] = now;
+    running += next == kRunning;
+  }
+  return running;
+}
+
+void GameBatch::run(const Policy& policy, double start, double dt, int64_t maxTicks, int threads) {
+  if (threads <= 0)
+    threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  int count = size();
+  threads = std::clamp(threads, 1, std::max(1, count));
+  // games never interact, so every worker runs its own range to the end without waiting for the others
+  auto work = [&](int begin, int end) {
+    std::vector<uint8_t> actions(end - begin);
+    for (int64_t tick = 0; tick < maxTicks; tick++) {
+      policy(*this, begin, end, tick, actions.data());
+      if (step(begin, end, actions.data(), start + static_cast<double>(tick + 1) * dt) == 0)
+        break;
+    }
+  };
+  if (threads == 1) {
+    work(0, count);
+    return;
+  }
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; t++)
+    workers.emplace_back(work, static_cast<int>(static_cast<int64_t>(count) * t / threads),
+                         static_cast<int>(static_cast<int64_t>(count) * (t + 1) / threads));
+  for (auto& worker : workers)
+    worker.join();
+}
+
+GameBatch::Summary GameBatch::summary() const {
+  Summary s;
+  s.games = size();
+  for (int i = 0; i < size(); i++) {
+    s.finished += endings[i] == kFinished;
+    s.failed += endings[i] == kFailed;
+    s.running += endings[i] == kRunning;
+    s.reachedExit += reachedExit(i);
+    s.moves += moves[i];
+  }
+  return s;
+}
+}
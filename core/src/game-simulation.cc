@@ -0,0 +1,130 @@
+#include <core/game-simulation.h>
+#include <core/profiler.h>
+#include <algorithm>
+#include <chrono>
+
+namespace core {
+glm::vec2 GameSnapshot::displayPos(const Map& map, double now) const {
+  float x = static_cast<float>(pos.x), y = static_cast<float>(pos.y);
+  if (now < lastOperationTime + kOperationInterval) {
+    float ratio = static_cast<float>(std::max(0.0, now - lastOperationTime) / kOperationInterval);
+    x = (1.f - ratio) * static_cast<float>(lastOperationPos.x) + x * ratio;
+    y = (1.f - ratio) * static_cast<float>(lastOperationPos.y) + y * ratio;
+  }
+  return glm::vec2(-1.f + x * 2.f / map.getWidth(), -1.f + y * 2.f / map.getHeight());
+}
+
+GameSimulation::GameSimulation(const Map& map, ActionQueue& actions, const Clock& clock, Config config,
+                               LatencyTrace* trace)
+  : map(map), actions(actions), clock(clock), config(config), trace(trace), state(map.getStart(), clock) {
+  this->config.tickRate = std::max(1.0, config.tickRate);
+  state.update(map);
+  publish(0);
+  snapshots.acquire();
+}
+
+GameSimulation::~GameSimulation() {
+  stop();
+}
+
+void GameSimulation::start() {
+  if (running.exchange(true))
+    return;
+  thread = std::make_unique<std::thread>([this]() { run(); });
+}
+
+void GameSimulation::stop() {
+  if (!running.exchange(false))
+    return;
+  if (thread->joinable())
+    thread->join();
+}
+
+const GameSnapshot& GameSimulation::latest(bool* fresh) {
+  bool acquired = snapshots.acquire();
+  if (fresh)
+    *fresh = acquired;
+  if (acquired && snapshots.front().captureNs)
+    acquiredCaptureNs.store(snapshots.front().captureNs, std::memory_order_release);
+  return snapshots.front();
+}
+
+GameSimulation::Stats GameSimulation::stats() const {
+  Stats s;
+  s.ticks = ticks.load(std::memory_order_relaxed);
+  s.actions = applied.load(std::memory_order_relaxed);
+  s.maxActionsPerTick = maxPerTick.load(std::memory_order_relaxed);
+  s.lateTicks = late.load(std::memory_order_relaxed);
+  return s;
+}
+
+void GameSimulation::publish(int64_t captureNs) {
+  GameSnapshot& snapshot = snapshots.back();
+  snapshot.pos = state.pos;
+  snapshot.lastOperationPos = state.lastOperationPos;
+  snapshot.color = state.color;
+  snapshot.ending = state.ending;
+  snapshot.lastOperationTime = state.lastOperationTime;
+  snapshot.tick = ticks.load(std::memory_order_relaxed);
+  snapshot.actions = applied.load(std::memory_order_relaxed);
+  // ticks outrun frames, a snapshot carrying an action is mostly replaced before it is drawn
+  if (pendingCaptureNs && acquiredCaptureNs.load(std::memory_order_acquire) >= pendingCaptureNs)
+    pendingCaptureNs = 0;
+  int64_t now = monotonicNs();
+  if (!pendingCaptureNs) {
+    pendingCaptureNs = captureNs;
+    pendingPublishedNs = now;
+  }
+  snapshot.captureNs = pendingCaptureNs;
+  // with the capture, the time it was first published, so the wait for the renderer counts as upload
+  snapshot.publishedNs = pendingCaptureNs ? pendingPublishedNs : now;
+  snapshots.publish();
+}
+
+void GameSimulation::run() {
+  auto period = static_cast<int64_t>(1e9 / config.tickRate);
+  int64_t next = monotonicNs();
+  HCI_PROFILE_THREAD("simulation");
+  while (running.load(std::memory_order_relaxed)) {
+    {
+      HCI_PROFILE_ZONE("tick");
+      int64_t popNs = monotonicNs();
+      int64_t oldestCaptureNs = 0;
+      // every action is checked on its own, a burst must not let the block jump over a tile it cannot enter
+      size_t count = actions.drain([&](const TimedEvent<ActionEvent>& event) {
+        if (trace) {
+          trace->record(TraceStage::Classify, event.captureNs, event.value.emitNs);
+          trace->record(TraceStage::Queue, event.value.emitNs, popNs);
+        }
+        if (state.ending != GameEnd::Running)
+          return;
+        state.apply(map, event.value);
+        state.update(map);
+        if (!oldestCaptureNs)
+          oldestCaptureNs = event.captureNs;
+      });
+      if (state.ending == GameEnd::Running)
+        state.update(map);
+      applied.fetch_add(count, std::memory_order_relaxed);
+      if (count > maxPerTick.load(std::memory_order_relaxed))
+        maxPerTick.store(count, std::memory_order_relaxed);
+      ticks.fetch_add(1, std::memory_order_relaxed);
+      publish(oldestCaptureNs);
+      if (trace && count)
+        trace->record(TraceStage::Apply, popNs, monotonicNs());
+    }
+    if (state.ending != GameEnd::Running)
+      break;
+
+    // ticks keep their spacing; after a stall of several ticks the schedule restarts instead of catching up
+    next += period;
+    int64_t now = monotonicNs();
+    if (now > next + 4 * period) {
+      late.fetch_add(1, std::memory_order_relaxed);
+      next = now;
+    }
+    else if (now < next)
+      std::this_thread::sleep_for(std::chrono::nanoseconds(next - now));
+  }
+}
+}
@@ -0,0 +1,72 @@
+#include <core/game-state.h>
+
+namespace core {
+void GameState::move(const Map& map, Action action) {
+  lastOperationPos = pos;
+  lastOperationTime = clock->now();
+  if (action == Action::Up)
+    pos.x--;
+  else if (action == Action::Down)
+    pos.x++;
+  else if (action == Action::Left)
+    pos.y--;
+  else if (action == Action::Right)
+    pos.y++;
+  else if (action == Action::Switch) {
+    if (color == TileState::Black)
+      color = TileState::White;
+    else
+      color = TileState::Black;
+  }
+}
+
+void GameState::apply(const Map& map, ActionEvent event) {
+  switch (event.status) {
+    case ActionStatus::Provisional:
+      tentative = Snapshot{pos, color};
+      move(map, event.action);
+      break;
+    case ActionStatus::Confirmed:
+      tentative.reset();
+      break;
+    case ActionStatus::Retracted:
+      if (tentative) {
+        lastOperationPos = pos;
+        lastOperationTime = clock->now();
+        pos = tentative->pos;
+        color = tentative->color;
+        tentative.reset();
+      }
+      break;
+    case ActionStatus::Final:
+      tentative.reset();
+      move(map, event.action);
+      break;
+  }
+}
+
+void GameState::update(const Map& map) {
+  time = clock->now();
+  // the outcome of a provisional move is only decided once it is confirmed
+  if (!tentative) {
+    if (!map.contains(pos))
+      ending = GameEnd::Failed;
+    assert(color == TileState::Black || color == TileState::White);
+    if (ending == GameEnd::Running) {
+      TileState here = map.tile(pos);
+      if (here == TileState::Empty)
+        ending = GameEnd::Failed;
+      if (here == TileState::Black && color == TileState::White)
+        ending = GameEnd::Failed;
+      if (here == TileState::White && color == TileState::Black)
+        ending = GameEnd::Failed;
+    }
+    if (map.isExit(pos)) {
+      ending = GameEnd::Finished;
+      return;
+    }
+  }
+  if (time > startTime + kMaxGameTime)
+    ending = GameEnd::Finished;
+}
+}
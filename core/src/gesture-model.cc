@@ -0,0 +1,532 @@
+#include <core/gesture-model.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <fstream>
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define HCI_HAS_AVX2_KERNEL 1
+#include <immintrin.h>
+#endif
+
+namespace core {
+namespace {
+// out[j] += sum_k x[k] * w[k * cols + j]
+void gemvScalar(const float* x, int n, const float* w, int cols, float* out) {
+  for (int k = 0; k < n; k++) {
+    float xk = x[k];
+    const float* row = w + k * cols;
+    for (int j = 0; j < cols; j++)
+      out[j] += xk * row[j];
+  }
+}
+
+#ifdef HCI_HAS_AVX2_KERNEL
+// columns from j on, 8 at a time and then one by one
+__attribute__((target("avx2,fma")))
+void gemvAvx2Tail(const float* x, int n, const float* w, int cols, int j, float* out) {
+  for (; j + 8 <= cols; j += 8) {
+    __m256 acc = _mm256_loadu_ps(out + j);
+    for (int k = 0; k < n; k++)
+      acc = _mm256_fmadd_ps(_mm256_set1_ps(x[k]), _mm256_loadu_ps(w + k * cols + j), acc);
+    _mm256_storeu_ps(out + j, acc);
+  }
+  for (; j < cols; j++) {
+    float acc = out[j];
+    for (int k = 0; k < n; k++)
+      acc += x[k] * w[k * cols + j];
+    out[j] = acc;
+  }
+}
+
+__attribute__((target("avx2,fma")))
+void gemvAvx2(const float* x, int n, const float* w, int cols, float* out) {
+  int j = 0;
+  // 32 columns at a time keeps four accumulators in registers across the whole reduction
+  for (; j + 32 <= cols; j += 32) {
+    __m256 acc0 = _mm256_loadu_ps(out + j);
+    __m256 acc1 = _mm256_loadu_ps(out + j + 8);
+    __m256 acc2 = _mm256_loadu_ps(out + j + 16);
+    __m256 acc3 = _mm256_loadu_ps(out + j + 24);
+    for (int k = 0; k < n; k++) {
+      __m256 xk = _mm256_set1_ps(x[k]);
+      const float* row = w + k * cols + j;
+      acc0 = _mm256_fmadd_ps(xk, _mm256_loadu_ps(row), acc0);
+      acc1 = _mm256_fmadd_ps(xk, _mm256_loadu_ps(row + 8), acc1);
+      acc2 = _mm256_fmadd_ps(xk, _mm256_loadu_ps(row + 16), acc2);
+      acc3 = _mm256_fmadd_ps(xk, _mm256_loadu_ps(row + 24), acc3);
+    }
+    _mm256_storeu_ps(out + j, acc0);
+    _mm256_storeu_ps(out + j + 8, acc1);
+    _mm256_storeu_ps(out + j + 16, acc2);
+    _mm256_storeu_ps(out + j + 24, acc3);
+  }
+  gemvAvx2Tail(x, n, w, cols, j, out);
+}
+
+// rows of out (ldo apart) += rows of x (ldx apart) * w
+// every output element sees the same sequence of fused multiply-adds as in gemvAvx2,
+// so a batch produces bit-identical results to evaluating its rows one at a time
+__attribute__((target("avx2,fma")))
+void gemmAvx2(const float* x, int rows, int ldx, int n, const float* w, int cols, float* out, int ldo) {
+  int wide = cols / 16 * 16;
+  int r = 0;
+  // 4 rows x 16 columns: the weight row is loaded once and reused for every row of the batch
+  for (; r + 4 <= rows; r += 4) {
+    const float* x0 = x + r * ldx;
+    float* o0 = out + r * ldo;
+    const float* x1 = x0 + ldx;
+    const float* x2 = x1 + ldx;
+    const float* x3 = x2 + ldx;
+    float* o1 = o0 + ldo;
+    float* o2 = o1 + ldo;
+    float* o3 = o2 + ldo;
+    // spelled out rather than as an array so all eight accumulators stay in registers at -O2
+    for (int j = 0; j < wide; j += 16) {
+      __m256 a00 = _mm256_loadu_ps(o0 + j), a01 = _mm256_loadu_ps(o0 + j + 8);
+      __m256 a10 = _mm256_loadu_ps(o1 + j), a11 = _mm256_loadu_ps(o1 + j + 8);
+      __m256 a20 = _mm256_loadu_ps(o2 + j), a21 = _mm256_loadu_ps(o2 + j + 8);
+      __m256 a30 = _mm256_loadu_ps(o3 + j), a31 = _mm256_loadu_ps(o3 + j + 8);
+      for (int k = 0; k < n; k++) {
+        __m256 w0 = _mm256_loadu_ps(w + k * cols + j);
+        __m256 w1 = _mm256_loadu_ps(w + k * cols + j + 8);
+        __m256 xk = _mm256_set1_ps(x0[k]);
+        a00 = _mm256_fmadd_ps(xk, w0, a00);
+        a01 = _mm256_fmadd_ps(xk, w1, a01);
+        xk = _mm256_set1_ps(x1[k]);
+        a10 = _mm256_fmadd_ps(xk, w0, a10);
+        a11 = _mm256_fmadd_ps(xk, w1, a11);
+        xk = _mm256_set1_ps(x2[k]);
+        a20 = _mm256_fmadd_ps(xk, w0, a20);
+        a21 = _mm256_fmadd_ps(xk, w1, a21);
+        xk = _mm256_set1_ps(x3[k]);
+        a30 = _mm256_fmadd_ps(xk, w0, a30);
+        a31 = _mm256_fmadd_ps(xk, w1, a31);
+      }
+      _mm256_storeu_ps(o0 + j, a00);
+      _mm256_storeu_ps(o0 + j + 8, a01);
+      _mm256_storeu_ps(o1 + j, a10);
+      _mm256_storeu_ps(o1 + j + 8, a11);
+      _mm256_storeu_ps(o2 + j, a20);
+      _mm256_storeu_ps(o2 + j + 8, a21);
+      _mm256_storeu_ps(o3 + j, a30);
+      _mm256_storeu_ps(o3 + j + 8, a31);
+    }
+    for (int i = 0; i < 4; i++)
+      gemvAvx2Tail(x0 + i * ldx, n, w, cols, wide, o0 + i * ldo);
+  }
+  for (; r < rows; r++)
+    gemvAvx2(x + r * ldx, n, w, cols, out + r * ldo);
+}
+#endif
+
+void gemmScalar(const float* x, int rows, int ldx, int n, const float* w, int cols, float* out, int ldo) {
+  for (int r = 0; r < rows; r++)
+    gemvScalar(x + r * ldx, n, w, cols, out + r * ldo);
+}
+
+bool cpuHasAvx2() {
+#ifdef HCI_HAS_AVX2_KERNEL
+  return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+  return false;
+#endif
+}
+
+float sigmoid(float x) {
+  return 1.f / (1.f + std::exp(-x));
+}
+
+// c = f * c + i * g, h = o * tanh(c) for u units, gates in keras order i, f, c, o
+void cellUpdateScalar(int u, const float* z, float* h, float* c) {
+  for (int j = 0; j < u; j++) {
+    float i = sigmoid(z[j]);
+    float f = sigmoid(z[u + j]);
+    float g = std::tanh(z[2 * u + j]);
+    float o = sigmoid(z[3 * u + j]);
+    c[j] = f * c[j] + i * g;
+    h[j] = o * std::tanh(c[j]);
+  }
+}
+
+#ifdef HCI_HAS_AVX2_KERNEL
+// cephes style exp: x = n ln2 + r, e^r by a degree 5 polynomial, 2^n through the exponent bits
+// within 2 ulp of std::exp over the clamped range, which is far below what the model can tell apart
+__attribute__((target("avx2,fma")))
+__m256 expAvx2(__m256 x) {
+  x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(-87.3f)), _mm256_set1_ps(88.3f));
+  __m256 n = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(1.44269504088896341f)),
+                             _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  __m256 r = _mm256_fnmadd_ps(n, _mm256_set1_ps(0.693359375f), x);
+  r = _mm256_fnmadd_ps(n, _mm256_set1_ps(-2.12194440e-4f), r);
+  __m256 p = _mm256_set1_ps(1.9875691500e-4f);
+  p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.3981999507e-3f));
+  p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(8.3334519073e-3f));
+  p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(4.1665795894e-2f));
+  p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.6666665459e-1f));
+  p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(5.0000001201e-1f));
+  p = _mm256_fmadd_ps(p, _mm256_mul_ps(r, r), _mm256_add_ps(r, _mm256_set1_ps(1.f)));
+  __m256i bits = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23);
+  return _mm256_mul_ps(p, _mm256_castsi256_ps(bits));
+}
+
+__attribute__((target("avx2,fma")))
+__m256 sigmoidAvx2(__m256 x) {
+  __m256 one = _mm256_set1_ps(1.f);
+  return _mm256_div_ps(one, _mm256_add_ps(one, expAvx2(_mm256_sub_ps(_mm256_setzero_ps(), x))));
+}
+
+// tanh(x) = 2 sigmoid(2x) - 1
+__attribute__((target("avx2,fma")))
+__m256 tanhAvx2(__m256 x) {
+  __m256 two = _mm256_set1_ps(2.f);
+  return _mm256_fmsub_ps(two, sigmoidAvx2(_mm256_mul_ps(two, x)), _mm256_set1_ps(1.f));
+}
+
+// the libm calls dominate a step once the products are vectorised, so the gates are evaluated 8 units at a time
+__attribute__((target("avx2,fma")))
+void cellUpdateAvx2(int u, const float* z, float* h, float* c) {
+  int j = 0;
+  for (; j + 8 <= u; j += 8) {
+    __m256 i = sigmoidAvx2(_mm256_loadu_ps(z + j));
+    __m256 f = sigmoidAvx2(_mm256_loadu_ps(z + u + j));
+    __m256 g = tanhAvx2(_mm256_loadu_ps(z + 2 * u + j));
+    __m256 o = sigmoidAvx2(_mm256_loadu_ps(z + 3 * u + j));
+    __m256 cj = _mm256_fmadd_ps(f, _mm256_loadu_ps(c + j), _mm256_mul_ps(i, g));
+    _mm256_storeu_ps(c + j, cj);
+    _mm256_storeu_ps(h + j, _mm256_mul_ps(o, tanhAvx2(cj)));
+  }
+  for (; j < u; j++) {
+    float i = sigmoid(z[j]);
+    float f = sigmoid(z[u + j]);
+    float g = std::tanh(z[2 * u + j]);
+    float o = sigmoid(z[3 * u + j]);
+    c[j] = f * c[j] + i * g;
+    h[j] = o * std::tanh(c[j]);
+  }
+}
+#endif
+
+struct WeightsHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t timeSteps, inputDim, lstm1Units, lstm2Units, denseUnits, numClasses;
+  float bnEpsilon;
+};
+// far above the model's sizes, low enough that no weight count overflows an int
+constexpr uint32_t kMaxWeightsDim = 4096;
+
+bool readFloats(std::ifstream& in, std::vector<float>& v, size_t count) {
+  v.resize(count);
+  return static_cast<bool>(in.read(reinterpret_cast<char*>(v.data()), count * sizeof(float)));
+}
+}
+
+bool GestureModel::load(const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    std::cerr << std::format("Failed to open gesture model {}", path) << std::endl;
+    return false;
+  }
+  WeightsHeader header{};
+  if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) || memcmp(header.magic, "HGCW", 4) != 0
+      || header.version != 1) {
+    std::cerr << std::format("{} is not a gesture model weights file", path) << std::endl;
+    return false;
+  }
+  for (uint32_t dim : {header.timeSteps, header.inputDim, header.lstm1Units, header.lstm2Units, header.denseUnits,
+                       header.numClasses}) {
+    if (dim == 0 || dim > kMaxWeightsDim) {
+      std::cerr << std::format("{} has a damaged header", path) << std::endl;
+      return false;
+    }
+  }
+  int in1 = header.inputDim, u1 = header.lstm1Units, u2 = header.lstm2Units, d = header.denseUnits,
+      c = header.numClasses;
+  std::vector<float> gamma, beta, mean, variance;
+  lstm1 = {in1, u1, {}, {}, {}};
+  lstm2 = {u1, u2, {}, {}, {}};
+  dense1 = {u2, d, {}, {}};
+  dense2 = {d, c, {}, {}};
+  bool ok = readFloats(in, gamma, in1) && readFloats(in, beta, in1)
+            && readFloats(in, mean, in1) && readFloats(in, variance, in1)
+            && readFloats(in, lstm1.kernel, in1 * 4 * u1) && readFloats(in, lstm1.recurrent, u1 * 4 * u1)
+            && readFloats(in, lstm1.bias, 4 * u1)
+            && readFloats(in, lstm2.kernel, u1 * 4 * u2) && readFloats(in, lstm2.recurrent, u2 * 4 * u2)
+            && readFloats(in, lstm2.bias, 4 * u2)
+            && readFloats(in, dense1.kernel, u2 * d) && readFloats(in, dense1.bias, d)
+            && readFloats(in, dense2.kernel, d * c) && readFloats(in, dense2.bias, c);
+  if (!ok || in.peek() != std::char_traits<char>::eof()) {
+    std::cerr << std::format("Gesture model {} has an unexpected size", path) << std::endl;
+    numClasses_ = 0;
+    return false;
+  }
+  bnScale.resize(in1);
+  bnShift.resize(in1);
+  for (int k = 0; k < in1; k++) {
+    bnScale[k] = gamma[k] / std::sqrt(variance[k] + header.bnEpsilon);
+    bnShift[k] = beta[k] - mean[k] * bnScale[k];
+  }
+  timeSteps_ = header.timeSteps;
+  inputDim_ = in1;
+  numClasses_ = c;
+  normalized.resize(in1);
+  projections.resize(timeSteps_ * 4 * u1);
+  gates.resize(4 * std::max(u1, u2));
+  sequence.resize(timeSteps_ * u1);
+  h1.resize(u1);
+  c1.resize(u1);
+  h2.resize(u2);
+  c2.resize(u2);
+  hidden.resize(d);
+  batchCapacity = 0;
+  setKernel(Kernel::Avx2);
+  return true;
+}
+
+void GestureModel::setKernel(Kernel k) {
+#ifdef HCI_HAS_AVX2_KERNEL
+  if (k == Kernel::Avx2 && cpuHasAvx2()) {
+    activeKernel = Kernel::Avx2;
+    gemv = gemvAvx2;
+    gemm = gemmAvx2;
+    cellUpdate = cellUpdateAvx2;
+    return;
+  }
+#endif
+  activeKernel = Kernel::Scalar;
+  gemv = gemvScalar;
+  gemm = gemmScalar;
+  cellUpdate = cellUpdateScalar;
+}
+
+void GestureModel::normalize(const float* x, float* out) const {
+  for (int k = 0; k < inputDim_; k++)
+    out[k] = x[k] * bnScale[k] + bnShift[k];
+}
+
+void GestureModel::projectInput(const LstmLayer& layer, const float* x, float* out) const {
+  std::copy(layer.bias.begin(), layer.bias.end(), out);
+  gemv(x, layer.inputDim, layer.kernel.data(), 4 * layer.units, out);
+}
+
+void GestureModel::recurrentStep(const LstmLayer& layer, float* z, float* h, float* c) const {
+  gemv(h, layer.units, layer.recurrent.data(), 4 * layer.units, z);
+  cellUpdate(layer.units, z, h, c);
+}
+
+void GestureModel::softmax(float* logits, int n) {
+  float maxLogit = *std::max_element(logits, logits + n);
+  float sum = 0.f;
+  for (int j = 0; j < n; j++) {
+    logits[j] = std::exp(logits[j] - maxLogit);
+    sum += logits[j];
+  }
+  for (int j = 0; j < n; j++)
+    logits[j] /= sum;
+}
+
+void GestureModel::dense(const DenseLayer& layer, const float* x, float* out) const {
+  std::copy(layer.bias.begin(), layer.bias.end(), out);
+  gemv(x, layer.inputDim, layer.kernel.data(), layer.units, out);
+}
+
+void GestureModel::predict(const float* window, float* probabilities) {
+  int stride = 4 * lstm1.units;
+  for (int t = 0; t < timeSteps_; t++) {
+    normalize(window + t * inputDim_, normalized.data());
+    projectInput(lstm1, normalized.data(), projections.data() + t * stride);
+  }
+  evaluate(projections.data(), 0, timeSteps_, probabilities);
+}
+
+void GestureModel::evaluate(const float* ring, int first, int steps, float* probabilities) {
+  int u1 = lstm1.units;
+  int stride = 4 * u1;
+  std::fill(h1.begin(), h1.end(), 0.f);
+  std::fill(c1.begin(), c1.end(), 0.f);
+  for (int t = 0; t < steps; t++) {
+    int slot = (first + t) % timeSteps_;
+    std::copy(ring + slot * stride, ring + (slot + 1) * stride, gates.begin());
+    recurrentStep(lstm1, gates.data(), h1.data(), c1.data());
+    std::copy(h1.begin(), h1.end(), sequence.begin() + t * u1);
+  }
+  std::fill(h2.begin(), h2.end(), 0.f);
+  std::fill(c2.begin(), c2.end(), 0.f);
+  for (int t = 0; t < steps; t++) {
+    projectInput(lstm2, sequence.data() + t * u1, gates.data());
+    recurrentStep(lstm2, gates.data(), h2.data(), c2.data());
+  }
+  dense(dense1, h2.data(), hidden.data());
+  for (auto& v : hidden)
+    v = std::max(v, 0.f);
+  dense(dense2, hidden.data(), probabilities);
+  softmax(probabilities, numClasses_);
+}
+
+void GestureModel::reserveBatch(int count) {
+  if (count <= batchCapacity)
+    return;
+  batchCapacity = count;
+  int u1 = lstm1.units, u2 = lstm2.units;
+  batch.normalized.resize(count * inputDim_);
+  batch.gates.resize(count * 4 * std::max(u1, u2));
+  batch.sequence.resize(static_cast<size_t>(timeSteps_) * count * u1);
+  batch.h1.resize(count * u1);
+  batch.c1.resize(count * u1);
+  batch.h2.resize(count * u2);
+  batch.c2.resize(count * u2);
+  batch.hidden.resize(count * dense1.units);
+}
+
+void GestureModel::predictBatch(const float* const* windows, int count, float* probabilities) {
+  reserveBatch(count);
+  int u1 = lstm1.units, u2 = lstm2.units, d = dense1.units;
+  auto broadcast = [count](const std::vector<float>& bias, float* out) {
+    for (int b = 0; b < count; b++)
+      std::copy(bias.begin(), bias.end(), out + b * bias.size());
+  };
+  std::fill_n(batch.h1.begin(), count * u1, 0.f);
+  std::fill_n(batch.c1.begin(), count * u1, 0.f);
+  for (int t = 0; t < timeSteps_; t++) {
+    for (int b = 0; b < count; b++)
+      normalize(windows[b] + t * inputDim_, batch.normalized.data() + b * inputDim_);
+    broadcast(lstm1.bias, batch.gates.data());
+    gemm(batch.normalized.data(), count, inputDim_, inputDim_, lstm1.kernel.data(), 4 * u1, batch.gates.data(), 4 * u1);
+    gemm(batch.h1.data(), count, u1, u1, lstm1.recurrent.data(), 4 * u1, batch.gates.data(), 4 * u1);
+    float* out = batch.sequence.data() + static_cast<size_t>(t) * count * u1;
+    for (int b = 0; b < count; b++) {
+      cellUpdate(u1, batch.gates.data() + b * 4 * u1, batch.h1.data() + b * u1, batch.c1.data() + b * u1);
+      std::copy_n(batch.h1.begin() + b * u1, u1, out + b * u1);
+    }
+  }
+  std::fill_n(batch.h2.begin(), count * u2, 0.f);
+  std::fill_n(batch.c2.begin(), count * u2, 0.f);
+  for (int t = 0; t < timeSteps_; t++) {
+    broadcast(lstm2.bias, batch.gates.data());
+    gemm(batch.sequence.data() + static_cast<size_t>(t) * count * u1, count, u1, u1, lstm2.kernel.data(), 4 * u2,
+         batch.gates.data(), 4 * u2);
+    gemm(batch.h2.data(), count, u2, u2, lstm2.recurrent.data(), 4 * u2, batch.gates.data(), 4 * u2);
+    for (int b = 0; b < count; b++)
+      cellUpdate(u2, batch.gates.data() + b * 4 * u2, batch.h2.data() + b * u2, batch.c2.data() + b * u2);
+  }
+  broadcast(dense1.bias, batch.hidden.data());
+  gemm(batch.h2.data(), count, u2, u2, dense1.kernel.data(), d, batch.hidden.data(), d);
+  for (int i = 0; i < count * d; i++)
+    batch.hidden[i] = std::max(batch.hidden[i], 0.f);
+  broadcast(dense2.bias, probabilities);
+  gemm(batch.hidden.data(), count, d, d, dense2.kernel.data(), numClasses_, probabilities, numClasses_);
+  for (int b = 0; b < count; b++)
+    softmax(probabilities + b * numClasses_, numClasses_);
+}
+
+int GestureModel::classify(const float* window, float threshold, float* confidence) {
+  float probabilities[16];
+  std::vector<float> large;
+  float* p = probabilities;
+  if (numClasses_ > 16) {
+    large.resize(numClasses_);
+    p = large.data();
+  }
+  predict(window, p);
+  return pickGesture(p, threshold, confidence);
+}
+
+int GestureModel::pickGesture(const float* probabilities, float threshold, float* confidence) const {
+  int best = static_cast<int>(std::max_element(probabilities, probabilities + numClasses_) - probabilities);
+  if (confidence)
+    *confidence = probabilities[best];
+  return probabilities[best] < threshold ? kInvalidGesture : best;
+}
+
+int64_t GestureModel::flopsPerInputStep() const {
+  // normalisation is one multiply-add per channel, the projection one per kernel entry
+  return 2 * static_cast<int64_t>(inputDim_) + 2 * static_cast<int64_t>(lstm1.kernel.size());
+}
+
+int64_t GestureModel::flopsPerWindow() const {
+  auto lstmStep = [](const LstmLayer& l) {
+    return 2 * static_cast<int64_t>(l.kernel.size() + l.recurrent.size()) + 4 * static_cast<int64_t>(l.units);
+  };
+  int64_t perStep = 2 * static_cast<int64_t>(inputDim_) + lstmStep(lstm1) + lstmStep(lstm2);
+  return perStep * timeSteps_ + 2 * static_cast<int64_t>(dense1.kernel.size() + dense2.kernel.size());
+}
+
+bool GestureModel::validate(const std::string& referencePath, float tolerance, std::ostream& log) {
+  std::ifstream in(referencePath, std::ios::binary);
+  char magic[4];
+  uint32_t count, windowLen, classes;
+  if (!in || !in.read(magic, 4) || memcmp(magic, "HGCR", 4) != 0
+      || !in.read(reinterpret_cast<char*>(&count), 4) || !in.read(reinterpret_cast<char*>(&windowLen), 4)
+      || !in.read(reinterpret_cast<char*>(&classes), 4)) {
+    std::cerr << std::format("{} is not a gesture reference file", referencePath) << std::endl;
+    return false;
+  }
+  if (static_cast<int>(windowLen) != windowSize() || static_cast<int>(classes) != numClasses_) {
+    std::cerr << std::format("Reference file {} does not match the loaded model", referencePath) << std::endl;
+    return false;
+  }
+  std::vector<float> window, expected, actual(numClasses_);
+  float maxError = 0.f;
+  int mismatches = 0;
+  uint32_t checked = 0;
+  for (; checked < count; checked++) {
+    if (!readFloats(in, window, windowLen) || !readFloats(in, expected, classes))
+      break;
+    predict(window.data(), actual.data());
+    for (int j = 0; j < numClasses_; j++)
+      maxError = std::max(maxError, std::abs(actual[j] - expected[j]));
+    if (std::max_element(actual.begin(), actual.end()) - actual.begin()
+        != std::max_element(expected.begin(), expected.end()) - expected.begin())
+      mismatches++;
+  }
+  bool passed = checked == count && checked > 0 && maxError <= tolerance && mismatches == 0;
+  log << std::format("Validated {} of {} windows ({} kernel): max abs error {:.3g}, argmax mismatches {} -> {}",
+                     checked, count, activeKernel == Kernel::Avx2 ? "avx2" : "scalar",
+                     maxError, mismatches, passed ? "PASS" : "FAIL") << std::endl;
+  return passed;
+}
+
+GestureStream::GestureStream(GestureModel& model)
+  : model(model), ring(model.timeSteps() * 4 * model.lstm1.units) {
+}
+
+void GestureStream::reset() {
+  head = 0;
+  frames = 0;
+}
+
+void GestureStream::append(const float* frame) {
+  int stride = 4 * model.lstm1.units;
+  int steps = model.timeSteps();
+  // head is the oldest slot, which the newest frame replaces once the ring is full
+  int slot = frames < steps ? frames : head;
+  model.normalize(frame, model.normalized.data());
+  model.projectInput(model.lstm1, model.normalized.data(), ring.data() + slot * stride);
+  if (frames >= steps)
+    head = (head + 1) % steps;
+  frames++;
+}
+
+bool GestureStream::push(const float* frame, float* probabilities) {
+  append(frame);
+  if (frames < model.timeSteps())
+    return false;
+  model.evaluate(ring.data(), head, model.timeSteps(), probabilities);
+  totalSaved += flopsSavedPerFrame();
+  return true;
+}
+
+bool GestureStream::predictRecent(int steps, float* probabilities) {
+  int stored = std::min<int64_t>(frames, model.timeSteps());
+  if (steps <= 0 || steps > stored)
+    return false;
+  model.evaluate(ring.data(), (head + stored - steps) % model.timeSteps(), steps, probabilities);
+  return true;
+}
+
+int64_t GestureStream::flopsSavedPerFrame() const {
+  return (model.timeSteps() - 1) * model.flopsPerInputStep();
+}
+}
@@ -0,0 +1,29 @@
+#include <core/gesture-pipeline.h>
+
+namespace core {
+GesturePipeline::GesturePipeline(GestureModel& model, SpeculativeGestureDetector::Config config)
+  : detector_(model, config) {
+}
+
+int GesturePipeline::push(const KeypointFrame& frame, int64_t captureNs, ActionQueue& actions, SessionLogWriter* log) {
+  GestureEvent events[SpeculativeGestureDetector::kMaxEvents];
+  window.push(frame);
+  int count = detector_.push(window.newest().data(), events);
+  if (log)
+    log->writeFrame(captureNs, frame);
+  int pushed = 0;
+  for (int i = 0; i < count; i++) {
+    if (log)
+      log->writeGesture(captureNs, events[i].gesture, events[i].confidence, events[i].status);
+    Action action;
+    if (!gestureToAction(events[i].gesture, action))
+      continue;
+    ActionEvent event{action, events[i].status};
+    if (log)
+      log->writeAction(captureNs, event);
+    actions.tryPush(event, captureNs);
+    pushed++;
+  }
+  return pushed;
+}
+}
@@ -0,0 +1,147 @@
+#include <core/gesture-service.h>
+#include <algorithm>
+#include <format>
+
+namespace core {
+GestureService::GestureService(const GestureModel& model, Config config) : model(model), config(config) {
+  if (model.windowSize() != kWindowFrames * kKeypointDim)
+    std::cerr << std::format("Gesture model takes {} values per window, the service expects {}",
+                             model.windowSize(), kWindowFrames * kKeypointDim) << std::endl;
+  this->config.maxBatch = std::max(1, config.maxBatch);
+  int maxBatch = this->config.maxBatch;
+  this->model.reserveBatch(maxBatch);
+  windows.resize(maxBatch);
+  windowPtrs.resize(maxBatch);
+  slots.resize(maxBatch);
+  probabilities.resize(maxBatch * model.numClasses());
+  for (int b = 0; b < maxBatch; b++)
+    windowPtrs[b] = windows[b].data();
+}
+
+GestureService::~GestureService() {
+  stop();
+}
+
+int GestureService::addStream(ActionQueue& actions) {
+  auto stream = std::make_unique<Stream>();
+  stream->actions = &actions;
+  streams.push_back(std::move(stream));
+  return static_cast<int>(streams.size()) - 1;
+}
+
+void GestureService::start() {
+  if (running.exchange(true))
+    return;
+  worker = std::make_unique<std::thread>([this]() { run(); });
+}
+
+void GestureService::stop() {
+  if (!running.exchange(false))
+    return;
+  wakeWord.fetch_add(1, std::memory_order_release);
+  detail::futexWakeAll(wakeWord);
+  if (worker->joinable())
+    worker->join();
+}
+
+bool GestureService::submit(int stream, std::span<const float> window, int64_t captureNs) {
+  Stream& s = *streams[stream];
+  Job job;
+  std::copy_n(window.begin(), std::min(window.size(), job.window.size()), job.window.begin());
+  job.submitNs = monotonicNs();
+  if (!s.pending.tryPush(job, captureNs))
+    return false;
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (sleeping.load(std::memory_order_relaxed)) {
+    wakeWord.fetch_add(1, std::memory_order_relaxed);
+    detail::futexWakeAll(wakeWord);
+  }
+  return true;
+}
+
+GestureService::Stats GestureService::stats() const {
+  Stats s;
+  s.batches = batches.load(std::memory_order_relaxed);
+  s.windows = processed.load(std::memory_order_relaxed);
+  s.maxLatencyNs = maxLatency.load(std::memory_order_relaxed);
+  s.totalLatencyNs = totalLatency.load(std::memory_order_relaxed);
+  for (const auto& stream : streams)
+    s.dropped += stream->pending.droppedCount();
+  return s;
+}
+
+int GestureService::collect(int count) {
+  // round robin so one busy stream cannot starve the others out of a batch
+  int numStreams = static_cast<int>(streams.size());
+  for (int visited = 0; visited < numStreams && count < config.maxBatch; visited++) {
+    int id = nextStream;
+    nextStream = nextStream + 1 == numStreams ? 0 : nextStream + 1;
+    count += static_cast<int>(streams[id]->pending.drain([&](const TimedEvent<Job>& job) {
+      windows[count] = job.value.window;
+      slots[count] = {id, job.captureNs, job.value.submitNs};
+    }, 1));
+  }
+  return count;
+}
+
+void GestureService::waitForWork(int64_t timeoutNs) {
+  uint32_t observed = wakeWord.load(std::memory_order_acquire);
+  sleeping.store(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  bool pending = std::any_of(streams.begin(), streams.end(),
+                             [](const auto& s) { return !s->pending.empty(); });
+  if (!pending && running.load(std::memory_order_relaxed))
+    detail::futexWait(wakeWord, observed, timeoutNs);
+  sleeping.store(0, std::memory_order_relaxed);
+}
+
+void GestureService::run() {
+  while (running.load(std::memory_order_relaxed)) {
+    int count = collect(0);
+    if (count == 0) {
+      waitForWork(100'000'000);
+      continue;
+    }
+    int64_t deadline = slots[0].submitNs + config.maxLatencyNs;
+    for (int b = 1; b < count; b++)
+      deadline = std::min(deadline, slots[b].submitNs + config.maxLatencyNs);
+    while (count < config.maxBatch) {
+      int64_t remaining = deadline - monotonicNs();
+      if (remaining <= 0 || !running.load(std::memory_order_relaxed))
+        break;
+      int before = count;
+      count = collect(count);
+      if (count == before)
+        waitForWork(remaining);
+    }
+    evaluate(count);
+  }
+}
+
+void GestureService::evaluate(int count) {
+  model.predictBatch(windowPtrs.data(), count, probabilities.data());
+  int64_t now = monotonicNs();
+  int64_t worst = 0, total = 0;
+  for (int b = 0; b < count; b++) {
+    const Slot& slot = slots[b];
+    Stream& stream = *streams[slot.stream];
+    float confidence;
+    int gesture = model.pickGesture(probabilities.data() + b * model.numClasses(), config.threshold, &confidence);
+    worst = std::max(worst, now - slot.submitNs);
+    total += now - slot.submitNs;
+    if (resultFn)
+      resultFn(slot.stream, gesture, confidence, slot.captureNs, slot.submitNs);
+    // windows slide by one frame, so a held gesture shows up in many of them; report it when it starts
+    if (gesture == stream.prevGesture)
+      continue;
+    stream.prevGesture = gesture;
+    if (Action action; gestureToAction(gesture, action))
+      stream.actions->tryPush({action}, slot.captureNs);
+  }
+  batches.fetch_add(1, std::memory_order_relaxed);
+  processed.fetch_add(count, std::memory_order_relaxed);
+  totalLatency.fetch_add(total, std::memory_order_relaxed);
+  if (worst > maxLatency.load(std::memory_order_relaxed))
+    maxLatency.store(worst, std::memory_order_relaxed);
+}
+}
@@ -0,0 +1,71 @@
+#include <core/gesture-speculation.h>
+#include <algorithm>
+
+namespace core {
+SpeculativeGestureDetector::SpeculativeGestureDetector(GestureModel& model, Config config)
+  : model(model), config(config), stream(model), full(model.numClasses()), recent(model.numClasses()) {
+  this->config.minSteps = std::max(1, config.minSteps);
+  this->config.earlySteps = std::clamp(config.earlySteps, this->config.minSteps, model.timeSteps());
+}
+
+void SpeculativeGestureDetector::reset() {
+  stream.reset();
+  prevFinal = kInvalidGesture;
+  prevEarly = kInvalidGesture;
+  pending = kInvalidGesture;
+}
+
+int SpeculativeGestureDetector::push(const float* frame, GestureEvent* events) {
+  int count = 0;
+  uint64_t now = counters.frames++;
+  float confidence = 0.f;
+  int gesture = kInvalidGesture;
+  if (stream.push(frame, full.data()))
+    gesture = model.pickGesture(full.data(), config.threshold, &confidence);
+
+  if (pending != kInvalidGesture) {
+    if (gesture == pending) {
+      events[count++] = {pending, ActionStatus::Confirmed, confidence};
+      counters.confirmed++;
+      counters.framesSaved += now - pendingFrame;
+      prevFinal = pending;
+      pending = kInvalidGesture;
+    }
+    else if ((gesture != kInvalidGesture && gesture != prevFinal)
+             || now - pendingFrame >= static_cast<uint64_t>(config.confirmFrames)) {
+      events[count++] = {pending, ActionStatus::Retracted, pendingConfidence};
+      counters.retracted++;
+      pending = kInvalidGesture;
+    }
+  }
+  // a held gesture is classified on every frame, only report it when it starts
+  if (pending == kInvalidGesture && gesture != prevFinal) {
+    prevFinal = gesture;
+    if (gesture != kInvalidGesture) {
+      events[count++] = {gesture, ActionStatus::Final, confidence};
+      counters.finals++;
+    }
+  }
+
+  if (!config.speculate || pending != kInvalidGesture)
+    return count;
+  // before the window fills every frame so far is used, afterwards only the newest earlySteps
+  int64_t seen = stream.framesSeen();
+  int steps = seen < model.timeSteps() ? static_cast<int>(seen) : config.earlySteps;
+  if (steps < config.minSteps || !stream.predictRecent(steps, recent.data()))
+    return count;
+  float early = 0.f;
+  int guess = model.pickGesture(recent.data(), config.earlyThreshold, &early);
+  if (guess == prevEarly)
+    return count;
+  prevEarly = guess;
+  if (guess != kInvalidGesture && guess != prevFinal) {
+    pending = guess;
+    pendingConfidence = early;
+    pendingFrame = now;
+    events[count++] = {guess, ActionStatus::Provisional, early};
+    counters.provisional++;
+  }
+  return count;
+}
+}
@@ -0,0 +1,25 @@
+#include <core/input-adapter.h>
+#include <core/timing.h>
+#include <iostream>
+
+namespace core {
+int GestureIdFilter::next(FILE* in, int64_t& captureNs) {
+  int v = kInvalidGesture;
+  if (fscanf(in, "%d", &v) == EOF) {
+    std::cerr << "Warning: reaching end of file" << std::endl;
+    return -1;
+  }
+  captureNs = monotonicNs();
+  if (echo)
+    printf("%d\n", v);
+  while (v == prev || v == kInvalidGesture) {
+    prev = v;
+    if (fscanf(in, "%d", &v) == EOF)
+      return -1;
+    captureNs = monotonicNs();
+    if (echo)
+      printf("%d\n", v);
+  }
+  return v;
+}
+}
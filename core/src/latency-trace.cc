@@ -0,0 +1,83 @@
+#include <core/latency-trace.h>
+#include <algorithm>
+#include <csignal>
+#include <format>
+
+namespace core {
+namespace {
+std::atomic_bool pendingSignal{false};
+
+void onSignal(int) {
+  pendingSignal.store(true, std::memory_order_relaxed);
+}
+
+const char* stageName(TraceStage stage) {
+  switch (stage) {
+    case TraceStage::Classify:
+      return "classify";
+    case TraceStage::Queue:
+      return "queue";
+    case TraceStage::Apply:
+      return "apply";
+    case TraceStage::Upload:
+      return "upload";
+    case TraceStage::Present:
+      return "present";
+    case TraceStage::Total:
+      return "total";
+    default:
+      return "?";
+  }
+}
+}
+
+int64_t LatencyHistogram::percentile(double q) const {
+  uint64_t n = count();
+  if (n == 0)
+    return 0;
+  auto rank = static_cast<uint64_t>(q * static_cast<double>(n - 1)) + 1;
+  uint64_t seen = 0;
+  for (int i = 0; i < kBuckets; i++) {
+    seen += buckets[i].load(std::memory_order_relaxed);
+    if (seen >= rank) {
+      uint64_t begin = bucketStart(i), end = i + 1 < kBuckets ? bucketStart(i + 1) : begin + 1;
+      return static_cast<int64_t>(std::min<uint64_t>((begin + end) / 2, maximum.load(std::memory_order_relaxed)));
+    }
+  }
+  return max();
+}
+
+void LatencyHistogram::reset() {
+  for (auto& b : buckets)
+    b.store(0, std::memory_order_relaxed);
+  total.store(0, std::memory_order_relaxed);
+  sum.store(0, std::memory_order_relaxed);
+  maximum.store(0, std::memory_order_relaxed);
+}
+
+void LatencyTrace::summary(std::ostream& out) const {
+  out << std::format("{:<9}{:>9}{:>11}{:>11}{:>11}{:>11}{:>11}", "stage", "count", "mean us", "p50 us", "p95 us",
+                     "p99 us", "max us") << std::endl;
+  for (int i = 0; i < static_cast<int>(TraceStage::Count); i++) {
+    const LatencyHistogram& h = stages[i];
+    if (h.count() == 0)
+      continue;
+    out << std::format("{:<9}{:>9}{:>11.1f}{:>11.1f}{:>11.1f}{:>11.1f}{:>11.1f}",
+                       stageName(static_cast<TraceStage>(i)), h.count(), h.mean() / 1e3, h.percentile(0.5) / 1e3,
+                       h.percentile(0.95) / 1e3, h.percentile(0.99) / 1e3, h.max() / 1e3) << std::endl;
+  }
+}
+
+void LatencyTrace::reset() {
+  for (auto& h : stages)
+    h.reset();
+}
+
+void LatencyTrace::installSignalHandler(int signal) {
+  std::signal(signal, onSignal);
+}
+
+bool LatencyTrace::signalled() {
+  return pendingSignal.exchange(false, std::memory_order_relaxed);
+}
+}
@@ -0,0 +1,250 @@
+#include <core/level-pack.h>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <format>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace core {
+static constexpr char kPackMagic[4] = {'H', 'C', 'I', 'P'};
+static constexpr uint32_t kPackVersion = 1;
+static constexpr size_t kSectionAlign = 64;
+
+static_assert(sizeof(PackFileHeader) == 32 && sizeof(PackIndexEntry) == 16, "pack headers are packed");
+static_assert(sizeof(PackLevelHeader) == 64, "a level header fills one section");
+static_assert(sizeof(Map::Chunk) == 1024 && sizeof(Point) == 8 && sizeof(glm::vec3) == 12,
+              "sections are stored as held in memory");
+
+static size_t alignUp(size_t n) {
+  return (n + kSectionAlign - 1) & ~(kSectionAlign - 1);
+}
+
+// offsets of the sections from the start of a level, worked out from the counts in its header
+struct PackLayout {
+  size_t chunks, directory, exits, exitKeys, distances, positions, colors, idx, end;
+  size_t directorySize;
+};
+
+static PackLayout packLayout(const PackLevelHeader& h) {
+  PackLayout l{};
+  size_t chunksX = (static_cast<size_t>(h.width) + Map::kChunkSize - 1) >> Map::kChunkBits;
+  size_t chunksY = (static_cast<size_t>(h.height) + Map::kChunkSize - 1) >> Map::kChunkBits;
+  l.directorySize = chunksX * chunksY;
+  l.chunks = sizeof(PackLevelHeader);
+  l.directory = l.chunks + alignUp(h.chunkCount * sizeof(Map::Chunk));
+  l.exits = l.directory + alignUp(l.directorySize * sizeof(uint32_t));
+  l.exitKeys = l.exits + alignUp(h.exitCount * sizeof(Point));
+  l.distances = l.exitKeys + alignUp(h.exitCount * sizeof(uint64_t));
+  l.positions = l.distances;
+  if (h.flags & kPackDistances)
+    l.positions += alignUp(h.distanceCount * sizeof(uint16_t));
+  l.colors = l.positions + alignUp(h.vertexCount * sizeof(glm::vec3));
+  l.idx = l.colors + alignUp(h.vertexCount * sizeof(glm::vec3));
+  l.end = l.idx + alignUp(h.indexCount * sizeof(uint32_t));
+  return l;
+}
+
+LevelPackWriter::~LevelPackWriter() {
+  if (fd >= 0)
+    ::close(fd);
+}
+
+bool LevelPackWriter::open(const std::string& path, Options packOptions) {
+  if (fd >= 0)
+    ::close(fd);
+  fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    std::cerr << std::format("Failed to create level pack {}: {}", path, strerror(errno)) << std::endl;
+    return false;
+  }
+  options = packOptions;
+  offset = 0;
+  index.clear();
+  failed = false;
+  // the real header is written last, until then the file is no pack; levels start 64 byte aligned
+  char header[kSectionAlign]{};
+  return write(header, sizeof(header));
+}
+
+bool LevelPackWriter::write(const void* bytes, size_t size) {
+  if (fd < 0 || failed)
+    return false;
+  auto* p = static_cast<const char*>(bytes);
+  size_t written = 0;
+  while (written < size) {
+    ssize_t n = ::write(fd, p + written, size - written);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0) {
+      std::cerr << std::format("Failed to write level pack: {}", strerror(errno)) << std::endl;
+      failed = true;
+      return false;
+    }
+    written += n;
+  }
+  offset += size;
+  return true;
+}
+
+bool LevelPackWriter::add(const Map& map, uint64_t seed, const DistanceField* field) {
+  if (fd < 0 || failed)
+    return false;
+  if (options.distances && !field) {
+    scratchField.build(map);
+    field = &scratchField;
+  }
+  distances.clear();
+  if (options.distances)
+    field->saveDistances(distances);
+  board.positions.clear();
+  board.colors.clear();
+  board.idx.clear();
+  if (options.vertices)
+    board.addTiles(map);
+
+  PackLevelHeader h{};
+  h.flags = (options.distances ? uint32_t{kPackDistances} : 0u) | (options.vertices ? uint32_t{kPackVertices} : 0u);
+  h.width = map.getWidth();
+  h.height = map.getHeight();
+  h.startX = map.getStart().x;
+  h.startY = map.getStart().y;
+  h.chunkCount = static_cast<uint32_t>(map.chunkCount());
+  h.exitCount = static_cast<uint32_t>(map.getExits().size());
+  h.distanceCount = static_cast<uint32_t>(distances.size());
+  h.vertexCount = static_cast<uint32_t>(board.positions.size());
+  h.indexCount = static_cast<uint32_t>(board.idx.size());
+  h.solutionLength = field ? field->solutionLength() : DistanceField::kUnreachable;
+  h.seed = seed;
+  PackLayout l = packLayout(h);
+  h.size = static_cast<uint32_t>(l.end);
+
+  buffer.assign(l.end, 0);
+  auto put = [&](size_t at, const auto& items) {
+    if (!items.empty())
+      memcpy(buffer.data() + at, items.data(), items.size() * sizeof(items[0]));
+  };
+  memcpy(buffer.data(), &h, sizeof(h));
+  put(l.chunks, map.chunkData());
+  put(l.directory, map.directoryData());
+  put(l.exits, map.getExits());
+  put(l.exitKeys, map.exitKeyData());
+  put(l.distances, distances);
+  put(l.positions, board.positions);
+  put(l.colors, board.colors);
+  put(l.idx, board.idx);
+  index.push_back({offset, h.size, 0});
+  return write(buffer.data(), buffer.size());
+}
+
+bool LevelPackWriter::close() {
+  if (fd < 0)
+    return !failed;
+  PackFileHeader header{};
+  memcpy(header.magic, kPackMagic, sizeof(kPackMagic));
+  header.version = kPackVersion;
+  header.levelCount = static_cast<uint32_t>(index.size());
+  header.indexOffset = offset;
+  header.fileSize = offset + index.size() * sizeof(PackIndexEntry);
+  write(index.data(), index.size() * sizeof(PackIndexEntry));
+  if (!failed && pwrite(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))) {
+    std::cerr << std::format("Failed to write level pack: {}", strerror(errno)) << std::endl;
+    failed = true;
+  }
+  ::close(fd);
+  fd = -1;
+  return !failed;
+}
+
+LevelPackReader::~LevelPackReader() {
+  if (data)
+    munmap(const_cast<char*>(data), length);
+}
+
+bool LevelPackReader::open(const std::string& path) {
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    std::cerr << std::format("Failed to open level pack {}: {}", path, strerror(errno)) << std::endl;
+    return false;
+  }
+  struct stat st{};
+  if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(PackFileHeader)) {
+    std::cerr << std::format("{} is not a level pack", path) << std::endl;
+    ::close(fd);
+    return false;
+  }
+  void* mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (mapping == MAP_FAILED) {
+    std::cerr << std::format("Failed to map level pack {}: {}", path, strerror(errno)) << std::endl;
+    return false;
+  }
+  // levels are picked one at a time, reading ahead would only fault in neighbours nobody asked for
+  madvise(mapping, st.st_size, MADV_RANDOM);
+  auto* candidate = static_cast<const PackFileHeader*>(mapping);
+  auto size = static_cast<size_t>(st.st_size);
+  if (memcmp(candidate->magic, kPackMagic, sizeof(kPackMagic)) != 0 || candidate->version != kPackVersion
+      || candidate->fileSize != size || candidate->indexOffset % alignof(PackIndexEntry) != 0
+      || candidate->indexOffset + candidate->levelCount * sizeof(PackIndexEntry) != size) {
+    std::cerr << std::format("{} is not a level pack (or a damaged one)", path) << std::endl;
+    munmap(mapping, st.st_size);
+    return false;
+  }
+  if (data)
+    munmap(const_cast<char*>(data), length);
+  data = static_cast<const char*>(mapping);
+  length = size;
+  header = candidate;
+  entries = reinterpret_cast<const PackIndexEntry*>(data + header->indexOffset);
+  return true;
+}
+
+bool LevelPackReader::level(size_t i, PackedLevel& level) const {
+  if (i >= size())
+    return false;
+  const PackIndexEntry& entry = entries[i];
+  if (entry.offset % kSectionAlign != 0 || entry.offset + sizeof(PackLevelHeader) > header->indexOffset)
+    return false;
+  const char* base = data + entry.offset;
+  auto* h = reinterpret_cast<const PackLevelHeader*>(base);
+  if (h->width <= 0 || h->height <= 0)
+    return false;
+  PackLayout l = packLayout(*h);
+  if (h->size != entry.size || l.end > h->size || entry.offset + h->size > header->indexOffset)
+    return false;
+
+  level.seed = h->seed;
+  level.width = h->width;
+  level.height = h->height;
+  level.start = Point(h->startX, h->startY);
+  level.solutionLength = h->solutionLength;
+  level.chunks = {reinterpret_cast<const Map::Chunk*>(base + l.chunks), h->chunkCount};
+  level.directory = {reinterpret_cast<const uint32_t*>(base + l.directory), l.directorySize};
+  level.exits = {reinterpret_cast<const Point*>(base + l.exits), h->exitCount};
+  level.exitKeys = {reinterpret_cast<const uint64_t*>(base + l.exitKeys), h->exitCount};
+  level.distances = {};
+  if (h->flags & kPackDistances)
+    level.distances = {reinterpret_cast<const uint16_t*>(base + l.distances), h->distanceCount};
+  level.positions = {reinterpret_cast<const glm::vec3*>(base + l.positions), h->vertexCount};
+  level.colors = {reinterpret_cast<const glm::vec3*>(base + l.colors), h->vertexCount};
+  level.idx = {reinterpret_cast<const uint32_t*>(base + l.idx), h->indexCount};
+
+  // a few entries per level, cheap enough to check every time: a map never reads outside its sections
+  for (uint32_t entry : level.directory) {
+    uint32_t chunk = entry & Map::kChunkMask;
+    if (chunk != Map::kNoChunk && chunk >= h->chunkCount)
+      return false;
+  }
+  for (auto exit : level.exits) {
+    if (exit.x < 0 || exit.x >= h->width || exit.y < 0 || exit.y >= h->height)
+      return false;
+  }
+  for (uint32_t v : level.idx) {
+    if (v >= h->vertexCount)
+      return false;
+  }
+  return true;
+}
+}
@@ -0,0 +1,183 @@
+#include <core/map-generator.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <random>
+#include <thread>
+
+namespace core {
+namespace {
+// the moves of one path: counter (path, 0) draws its length, (path, 1), (path, 2), ... 64 moves each, two
+// bits per move. Like the generator this replaces, walks only take the four directions, never Switch.
+class PathWalk {
+  public:
+    PathWalk(const Philox4x32& rng, int path, const MapSpec& spec) : rng(rng), path(static_cast<uint64_t>(path)) {
+      uint32_t span = static_cast<uint32_t>(std::max(1, spec.maxPathLen - spec.minPathLen));
+      length = spec.minPathLen + static_cast<int>(Philox4x32::below(rng(path, 0)[0], span));
+    }
+    [[nodiscard]] int steps() const {
+      return length;
+    }
+    Action next() {
+      if (left == 0) {
+        block = rng(path, ++counter);
+        left = 64;
+      }
+      --left;
+      uint32_t& word = block[left / 16];
+      auto action = static_cast<Action>(word & 3);
+      word >>= 2;
+      return action;
+    }
+
+  private:
+    const Philox4x32& rng;
+    uint64_t path;
+    uint64_t counter{};
+    Philox4x32::Block block{};
+    int length{}, left{};
+};
+
+// the tiles a run of consecutive paths leaves behind: first is what an untouched tile ends up as (Empty when
+// the run never visits it), rest what a tile already holding something ends up as. A run starting at the
+// first path has nothing before it and keeps no rest.
+struct PathRun {
+  PathRun(int width, int height, Point start, bool withRest) : first(width, height, start) {
+    if (withRest)
+      rest.emplace(width, height, start);
+  }
+  // a walk visit turns a fresh tile the path's color and a used one Gray
+  void visit(Point p, TileState color) {
+    first.setTile(p, first.tile(p) == TileState::Empty ? color : TileState::Gray);
+    if (rest)
+      rest->setTile(p, TileState::Gray);
+  }
+  // the end of a path takes its color whatever was there
+  void paint(Point p, TileState color) {
+    first.setTile(p, color);
+    if (rest)
+      rest->setTile(p, color);
+  }
+  Map first;
+  std::optional<Map> rest;
+  std::vector<Point> exits;
+};
+
+// splits [0, count) into parts contiguous ranges and runs fn(part, begin, end) for each on its own thread
+template <typename Fn>
+void forRanges(int count, int parts, Fn&& fn) {
+  if (parts <= 1) {
+    fn(0, 0, count);
+    return;
+  }
+  std::vector<std::thread> workers;
+  for (int p = 0; p < parts; p++)
+    workers.emplace_back([&, p]() { fn(p, count * p / parts, count * (p + 1) / parts); });
+  for (auto& worker : workers)
+    worker.join();
+}
+}
+
+MapGenerator::MapGenerator(int threads)
+  : threads(threads > 0 ? threads : std::max(1, static_cast<int>(std::thread::hardware_concurrency()))) {
+}
+
+uint64_t MapGenerator::randomSeed() {
+  std::random_device device;
+  return (static_cast<uint64_t>(device()) << 32) | device();
+}
+
+Map MapGenerator::generate(const MapSpec& spec, uint64_t seed) const {
+  // a thread costs tens of microseconds to start, only spread paths out when each worker gets thousands of moves
+  int64_t moves = static_cast<int64_t>(spec.numPaths) * (spec.minPathLen + spec.maxPathLen) / 2;
+  int workers = static_cast<int>(std::clamp<int64_t>(moves / 16384, 1, std::min(threads, std::max(1, spec.numPaths))));
+  return generate(spec, seed, workers);
+}
+
+MapGenerator::Bounds MapGenerator::pathBounds(const Philox4x32& rng, const MapSpec& spec, int firstPath,
+                                              int lastPath) {
+  Bounds bounds;
+  for (int path = firstPath; path < lastPath; path++) {
+    PathWalk walk(rng, path, spec);
+    Point pos{0, 0};
+    for (int i = 0; i < walk.steps(); i++) {
+      const Point& change = coordChanges[static_cast<int>(walk.next())];
+      pos = {pos.x + change.x, pos.y + change.y};
+      bounds.minX = std::min(bounds.minX, pos.x);
+      bounds.maxX = std::max(bounds.maxX, pos.x);
+      bounds.minY = std::min(bounds.minY, pos.y);
+      bounds.maxY = std::max(bounds.maxY, pos.y);
+    }
+  }
+  return bounds;
+}
+
+Map MapGenerator::generate(const MapSpec& spec, uint64_t seed, int workers) const {
+  Philox4x32 rng(seed);
+  int numPaths = std::max(0, spec.numPaths);
+  workers = std::clamp(workers, 1, std::max(1, numPaths));
+
+  // the walks are cheap to redo, so the extent is found in a first pass rather than by storing every move
+  std::vector<Bounds> partBounds(workers);
+  forRanges(numPaths, workers, [&](int part, int begin, int end) {
+    partBounds[part] = pathBounds(rng, spec, begin, end);
+  });
+  Bounds bounds;
+  for (const auto& b : partBounds) {
+    bounds.minX = std::min(bounds.minX, b.minX);
+    bounds.maxX = std::max(bounds.maxX, b.maxX);
+    bounds.minY = std::min(bounds.minY, b.minY);
+    bounds.maxY = std::max(bounds.maxY, b.maxY);
+  }
+  int width = bounds.maxX - bounds.minX + 1, height = bounds.maxY - bounds.minY + 1;
+  Point start{-bounds.minX, -bounds.minY};
+
+  std::vector<std::unique_ptr<PathRun>> runs(workers);
+  forRanges(numPaths, workers, [&](int part, int begin, int end) {
+    auto run = std::make_unique<PathRun>(width, height, start, part > 0);
+    TileState color = TileState::Black;
+    for (int path = begin; path < end; path++) {
+      PathWalk walk(rng, path, spec);
+      Point pos{start};
+      for (int i = 0; i < walk.steps(); i++) {
+        run->visit(pos, color);
+        const Point& change = coordChanges[static_cast<int>(walk.next())];
+        pos = {pos.x + change.x, pos.y + change.y};
+      }
+      run->paint(pos, color);
+      run->exits.push_back(pos);
+    }
+    runs[part] = std::move(run);
+  });
+
+  // runs are applied in path order: a tile keeps the first run that touches it as is, later runs find it taken
+  Map map = std::move(runs[0]->first);
+  for (auto exit : runs[0]->exits)
+    map.addExit(exit);
+  for (int part = 1; part < workers; part++) {
+    const PathRun& run = *runs[part];
+    run.first.forEachTile([&](int x, int y, TileState state) {
+      map.setTile(x, y, map.tile(x, y) == TileState::Empty ? state : run.rest->tile(x, y));
+    });
+    for (auto exit : run.exits)
+      map.addExit(exit);
+  }
+  return map;
+}
+
+std::vector<Map> MapGenerator::generateBatch(const MapSpec& spec, uint64_t firstSeed, int count) const {
+  std::vector<Map> maps;
+  maps.reserve(std::max(0, count));
+  for (int i = 0; i < count; i++)
+    maps.emplace_back(0, 0, Point{});
+  // maps vary a lot in size, so workers take the next seed as they finish instead of a fixed share
+  std::atomic<int> next{0};
+  forRanges(threads, std::min(threads, count), [&](int, int, int) {
+    for (int i = next.fetch_add(1, std::memory_order_relaxed); i < count;
+         i = next.fetch_add(1, std::memory_order_relaxed))
+      maps[i] = generate(spec, firstSeed + i, 1);
+  });
+  return maps;
+}
+}
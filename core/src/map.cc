@@ -0,0 +1,95 @@
+#include <core/map.h>
+#include <format>
+#include <iostream>
+
+namespace core {
+Map::Map(int width, int height, Point start) : start(start) {
+  allocate(width, height);
+}
+
+Map::Map(int width, int height, Point start, std::span<const Chunk> chunks, std::span<const uint32_t> directory,
+         std::span<const Point> exits, std::span<const uint64_t> exitKeys)
+  : chunkView(chunks), directoryView(directory), exitView(exits), exitKeyView(exitKeys), start(start),
+    width(width), height(height), isBorrowed(true) {
+  chunksX = (width + kChunkSize - 1) >> kChunkBits;
+  chunksY = (height + kChunkSize - 1) >> kChunkBits;
+  assert(directory.size() == static_cast<size_t>(chunksX) * chunksY && exits.size() == exitKeys.size());
+}
+
+void Map::allocate(int w, int h) {
+  width = w;
+  height = h;
+  chunksX = (w + kChunkSize - 1) >> kChunkBits;
+  chunksY = (h + kChunkSize - 1) >> kChunkBits;
+  directory.assign(static_cast<size_t>(chunksX) * chunksY, kNoChunk);
+  chunks.clear();
+  exits.clear();
+  exitKeys.clear();
+  isBorrowed = false;
+  sync();
+}
+
+void Map::own() {
+  if (!isBorrowed)
+    return;
+  chunks.assign(chunkView.begin(), chunkView.end());
+  directory.assign(directoryView.begin(), directoryView.end());
+  exits.assign(exitView.begin(), exitView.end());
+  exitKeys.assign(exitKeyView.begin(), exitKeyView.end());
+  isBorrowed = false;
+  sync();
+}
+
+void Map::sync() {
+  chunkView = chunks;
+  directoryView = directory;
+  exitView = exits;
+  exitKeyView = exitKeys;
+}
+
+void Map::setTile(int x, int y, TileState state) {
+  assert(x >= 0 && x < width && y >= 0 && y < height);
+  own();
+  uint32_t& entry = directory[chunkIndex(x, y)];
+  uint32_t chunk = entry & kChunkMask;
+  if (chunk == kNoChunk) {
+    // clearing a tile of an empty chunk changes nothing
+    if (state == TileState::Empty)
+      return;
+    chunk = static_cast<uint32_t>(chunks.size());
+    chunks.emplace_back();
+    entry = (entry & kExitFlag) | chunk;
+  }
+  uint32_t m = morton(x & (kChunkSize - 1), y & (kChunkSize - 1));
+  uint64_t& word = chunks[chunk].words[m / kTilesPerWord];
+  int shift = 2 * (m % kTilesPerWord);
+  word = (word & ~(uint64_t{3} << shift)) | (static_cast<uint64_t>(state) << shift);
+  sync();
+}
+
+void Map::addExit(Point p) {
+  assert(contains(p));
+  uint64_t k = key(p.x, p.y);
+  auto it = std::lower_bound(exitKeyView.begin(), exitKeyView.end(), k);
+  if (it != exitKeyView.end() && *it == k)
+    return;
+  size_t at = it - exitKeyView.begin();
+  own();
+  exitKeys.insert(exitKeys.begin() + static_cast<ptrdiff_t>(at), k);
+  exits.push_back(p);
+  directory[chunkIndex(p.x, p.y)] |= kExitFlag;
+  sync();
+}
+
+void Map::getMapInfo() const {
+  std::cout << std::format("Map width: {}, height: {}", width, height) << std::endl;
+  std::cout << std::format("Start point: ({}, {})", start.x, start.y) << std::endl;
+  std::cout << std::format("{} of {} chunks allocated, {} bytes{}", chunkView.size(), directoryView.size(),
+                           memoryBytes(), isBorrowed ? " (borrowed)" : "") << std::endl;
+}
+
+size_t Map::memoryBytes() const {
+  return chunks.capacity() * sizeof(Chunk) + directory.capacity() * sizeof(uint32_t)
+         + exits.capacity() * sizeof(Point) + exitKeys.capacity() * sizeof(uint64_t);
+}
+}
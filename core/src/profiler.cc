@@ -0,0 +1,132 @@
+#include <core/profiler.h>
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <iostream>
+
+namespace core {
+// track ids of named tracks start here, above any thread's
+static constexpr int kFirstTrackId = 1000;
+
+Profiler& Profiler::instance() {
+  static Profiler profiler;
+  return profiler;
+}
+
+void Profiler::start() {
+  on.store(true, std::memory_order_relaxed);
+}
+
+void Profiler::stop() {
+  on.store(false, std::memory_order_relaxed);
+}
+
+Profiler::ThreadBuffer& Profiler::local() {
+  // registered once per thread, the only time recording takes the lock
+  thread_local ThreadBuffer* buffer = nullptr;
+  if (!buffer) {
+    std::lock_guard lock(mutex);
+    threads.push_back(std::make_unique<ThreadBuffer>());
+    buffer = threads.back().get();
+    buffer->tid = static_cast<int>(threads.size());
+  }
+  return *buffer;
+}
+
+void Profiler::record(const char* name, int64_t beginNs, int64_t endNs) {
+  local().ring.tryPush({name, nullptr, beginNs}, endNs);
+}
+
+void Profiler::record(const char* track, const char* name, int64_t beginNs, int64_t endNs) {
+  local().ring.tryPush({name, track, beginNs}, endNs);
+}
+
+void Profiler::nameThread(const std::string& name) {
+  ThreadBuffer& buffer = local();
+  std::lock_guard lock(mutex);
+  buffer.name = name;
+}
+
+int Profiler::trackId(const char* track) {
+  for (size_t i = 0; i < tracks.size(); i++)
+    if (tracks[i] == track)
+      return kFirstTrackId + static_cast<int>(i);
+  tracks.emplace_back(track);
+  return kFirstTrackId + static_cast<int>(tracks.size()) - 1;
+}
+
+void Profiler::collect() {
+  std::lock_guard lock(mutex);
+  for (auto& thread : threads) {
+    thread->ring.drain([&](const TimedEvent<Record>& event) {
+      const Record& r = event.value;
+      zones.push_back({r.name, r.track ? trackId(r.track) : thread->tid, r.beginNs, event.captureNs});
+    });
+  }
+}
+
+void Profiler::clear() {
+  collect();
+  std::lock_guard lock(mutex);
+  zones.clear();
+}
+
+size_t Profiler::zoneCount() {
+  collect();
+  std::lock_guard lock(mutex);
+  return zones.size();
+}
+
+uint64_t Profiler::dropped() const {
+  std::lock_guard lock(mutex);
+  uint64_t n = 0;
+  for (const auto& thread : threads)
+    n += thread->ring.droppedCount();
+  return n;
+}
+
+// names come from string literals, but a quote or backslash must not break the file
+static std::string jsonString(std::string_view text) {
+  std::string escaped;
+  for (char c : text) {
+    if (c == '"' || c == '\\')
+      escaped += '\\';
+    escaped += c;
+  }
+  return escaped;
+}
+
+bool Profiler::writeChromeTrace(const std::string& path) {
+  collect();
+  std::lock_guard lock(mutex);
+  std::ofstream out(path);
+  if (!out) {
+    std::cerr << std::format("Failed to write profile {}", path) << std::endl;
+    return false;
+  }
+  int64_t origin = zones.empty() ? 0 : zones.front().beginNs;
+  for (const Zone& zone : zones)
+    origin = std::min(origin, zone.beginNs);
+  // complete ("X") events in microseconds from the first zone, then names for the tracks
+  out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+  const char* separator = "\n  ";
+  for (const Zone& zone : zones) {
+    out << std::format("{}{{\"name\": \"{}\", \"ph\": \"X\", \"pid\": 1, \"tid\": {}, "
+                       "\"ts\": {:.3f}, \"dur\": {:.3f}}}", separator, jsonString(zone.name), zone.tid,
+                       (zone.beginNs - origin) / 1e3, (zone.endNs - zone.beginNs) / 1e3);
+    separator = ",\n  ";
+  }
+  auto trackName = [&](int tid, const std::string& name) {
+    out << std::format("{}{{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": {}, "
+                       "\"args\": {{\"name\": \"{}\"}}}}", separator, tid, jsonString(name));
+    separator = ",\n  ";
+  };
+  for (const auto& thread : threads)
+    trackName(thread->tid, thread->name.empty() ? std::format("thread {}", thread->tid) : thread->name);
+  for (size_t i = 0; i < tracks.size(); i++)
+    trackName(kFirstTrackId + static_cast<int>(i), tracks[i]);
+  out << "\n]}\n";
+  return static_cast<bool>(out);
+}
+}
@@ -0,0 +1,170 @@
+#include <core/serial-reader.h>
+#include <cerrno>
+#include <charconv>
+#include <fcntl.h>
+#include <format>
+#include <iostream>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace core {
+static bool isBlank(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+bool KeypointParser::parseFrame(const char* begin, const char* end, KeypointFrame& out) {
+  const char* p = begin;
+  for (int i = 0; i < kKeypointDim; i++) {
+    while (p < end && isBlank(*p)) p++;
+    auto [next, ec] = std::from_chars(p, end, out[i]);
+    if (ec != std::errc())
+      return false;
+    p = next;
+    while (p < end && isBlank(*p)) p++;
+    if (i + 1 < kKeypointDim) {
+      if (p == end || *p != ',')
+        return false;
+      p++;
+    }
+  }
+  return p == end;
+}
+
+static speed_t baudConstant(int baudRate) {
+  switch (baudRate) {
+    case 9600: return B9600;
+    case 19200: return B19200;
+    case 38400: return B38400;
+    case 57600: return B57600;
+    case 115200: return B115200;
+    case 230400: return B230400;
+    case 460800: return B460800;
+    case 921600: return B921600;
+    default: return B0;
+  }
+}
+
+SerialKeypointReader::SerialKeypointReader(std::string device, int baudRate)
+  : device(std::move(device)), baudRate(baudRate) {
+}
+
+SerialKeypointReader::~SerialKeypointReader() {
+  stop();
+  if (fd >= 0)
+    close(fd);
+}
+
+bool SerialKeypointReader::open() {
+  speed_t speed = baudConstant(baudRate);
+  if (speed == B0) {
+    std::cerr << std::format("Unsupported baud rate {}", baudRate) << std::endl;
+    return false;
+  }
+  int dev = ::open(device.c_str(), O_RDWR | O_NOCTTY | O_CLOEXEC);
+  if (dev < 0) {
+    std::cerr << std::format("Failed to open {}: {}", device, strerror(errno)) << std::endl;
+    return false;
+  }
+  termios tty{};
+  if (tcgetattr(dev, &tty) != 0) {
+    std::cerr << std::format("{} is not a terminal: {}", device, strerror(errno)) << std::endl;
+    ::close(dev);
+    return false;
+  }
+  cfmakeraw(&tty);
+  cfsetispeed(&tty, speed);
+  cfsetospeed(&tty, speed);
+  tty.c_cflag |= CLOCAL | CREAD;
+  // reads are driven by poll, let read return whatever is there
+  tty.c_cc[VMIN] = 0;
+  tty.c_cc[VTIME] = 0;
+  if (tcsetattr(dev, TCSANOW, &tty) != 0) {
+    std::cerr << std::format("Failed to configure {}: {}", device, strerror(errno)) << std::endl;
+    ::close(dev);
+    return false;
+  }
+  tcflush(dev, TCIFLUSH);
+  attach(dev);
+  return true;
+}
+
+void SerialKeypointReader::attach(int dev) {
+  if (fd >= 0)
+    ::close(fd);
+  fd = dev;
+}
+
+void SerialKeypointReader::start() {
+  if (fd < 0 || running.exchange(true))
+    return;
+  eof.store(false, std::memory_order_release);
+  thread = std::make_unique<std::thread>([this]() { readLoop(); });
+}
+
+void SerialKeypointReader::stop() {
+  running = false;
+  if (thread && thread->joinable())
+    thread->join();
+  thread.reset();
+}
+
+void SerialKeypointReader::readLoop() {
+  // frames are at most a few hundred bytes, so a frame never outgrows this buffer
+  // unconsumed bytes are moved to the front after every parse so from_chars always sees contiguous text
+  std::array<char, 4096> rx;
+  size_t used = 0;
+  uint64_t overruns = 0;
+  KeypointParser parser;
+  pollfd pfd{fd, POLLIN, 0};
+  while (running.load(std::memory_order_relaxed)) {
+    int ready = poll(&pfd, 1, 100);
+    if (ready < 0 && errno != EINTR)
+      break;
+    if (ready <= 0)
+      continue;
+    ssize_t n = read(fd, rx.data() + used, rx.size() - used);
+    if (n < 0 && (errno == EINTR || errno == EAGAIN))
+      continue;
+    // a closed pipe reads 0, a pty whose master went away fails with EIO
+    if (n <= 0)
+      break;
+    int64_t captureNs = monotonicNs();
+    totalBytes.fetch_add(n, std::memory_order_relaxed);
+    used += n;
+    size_t consumed = parser.parse(rx.data(), used, [&](const KeypointFrame& frame) {
+      frames.tryPush(frame, captureNs);
+    });
+    if (consumed == 0 && used == rx.size()) {
+      // garbage without a closing bracket, nothing to resynchronise on
+      overruns++;
+      consumed = used;
+    }
+    memmove(rx.data(), rx.data() + consumed, used - consumed);
+    used -= consumed;
+    malformed.store(parser.malformedCount() + overruns, std::memory_order_relaxed);
+  }
+  eof.store(true, std::memory_order_release);
+  frames.close();
+}
+
+int openPseudoTerminal(std::string& slavePath) {
+  int master = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+  if (master < 0) {
+    std::cerr << std::format("Failed to open a pseudo-terminal: {}", strerror(errno)) << std::endl;
+    return -1;
+  }
+  if (grantpt(master) != 0 || unlockpt(master) != 0) {
+    std::cerr << std::format("Failed to unlock pseudo-terminal: {}", strerror(errno)) << std::endl;
+    close(master);
+    return -1;
+  }
+  char name[128];
+  if (ptsname_r(master, name, sizeof(name)) != 0) {
+    close(master);
+    return -1;
+  }
+  slavePath = name;
+  return master;
+}
+}
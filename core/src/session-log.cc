@@ -0,0 +1,173 @@
+#include <core/session-log.h>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <format>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace core {
+static constexpr char kLogMagic[4] = {'H', 'C', 'I', 'L'};
+static constexpr uint32_t kLogVersion = 1;
+
+static_assert(sizeof(LogFileHeader) == 16 && sizeof(LogRecordHeader) == 16, "log headers are 16 bytes");
+static_assert(sizeof(LogAction) == 16 && sizeof(LogGesture) == 8, "log payloads are padded to 8 bytes");
+
+SessionLogWriter::~SessionLogWriter() {
+  close();
+}
+
+bool SessionLogWriter::open(const std::string& path) {
+  close();
+  fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    std::cerr << std::format("Failed to create session log {}: {}", path, strerror(errno)) << std::endl;
+    return false;
+  }
+  buffer.reserve(kBufferSize);
+  seq = 0;
+  failed = false;
+  LogFileHeader header{};
+  memcpy(header.magic, kLogMagic, sizeof(kLogMagic));
+  header.version = kLogVersion;
+  header.startNs = monotonicNs();
+  auto* bytes = reinterpret_cast<const char*>(&header);
+  buffer.insert(buffer.end(), bytes, bytes + sizeof(header));
+  return true;
+}
+
+void SessionLogWriter::append(LogRecordType type, uint8_t status, int64_t timeNs, const void* payload, size_t size) {
+  if (fd < 0)
+    return;
+  if (buffer.size() + sizeof(LogRecordHeader) + size > kBufferSize)
+    flush();
+  LogRecordHeader header{type, status, static_cast<uint16_t>(size), seq++, timeNs};
+  auto* bytes = reinterpret_cast<const char*>(&header);
+  buffer.insert(buffer.end(), bytes, bytes + sizeof(header));
+  bytes = static_cast<const char*>(payload);
+  buffer.insert(buffer.end(), bytes, bytes + size);
+}
+
+void SessionLogWriter::writeFrame(int64_t captureNs, const KeypointFrame& frame) {
+  append(LogRecordType::Keypoints, 0, captureNs, frame.data(), sizeof(frame));
+}
+
+void SessionLogWriter::writeGesture(int64_t captureNs, int gesture, float confidence, ActionStatus status) {
+  LogGesture payload{gesture, confidence};
+  append(LogRecordType::Gesture, static_cast<uint8_t>(status), captureNs, &payload, sizeof(payload));
+}
+
+void SessionLogWriter::writeAction(int64_t captureNs, const ActionEvent& event) {
+  LogAction payload{event.action, {}, event.emitNs};
+  append(LogRecordType::Action, static_cast<uint8_t>(event.status), captureNs, &payload, sizeof(payload));
+}
+
+bool SessionLogWriter::flush() {
+  if (fd < 0 || failed)
+    return !failed;
+  size_t written = 0;
+  while (written < buffer.size()) {
+    ssize_t n = ::write(fd, buffer.data() + written, buffer.size() - written);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0) {
+      std::cerr << std::format("Failed to write session log: {}", strerror(errno)) << std::endl;
+      failed = true;
+      break;
+    }
+    written += n;
+  }
+  buffer.clear();
+  return !failed;
+}
+
+void SessionLogWriter::close() {
+  if (fd < 0)
+    return;
+  flush();
+  ::close(fd);
+  fd = -1;
+}
+
+SessionLogReader::~SessionLogReader() {
+  if (data)
+    munmap(const_cast<char*>(data), length);
+}
+
+bool SessionLogReader::open(const std::string& path) {
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    std::cerr << std::format("Failed to open session log {}: {}", path, strerror(errno)) << std::endl;
+    return false;
+  }
+  struct stat st{};
+  if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(LogFileHeader)) {
+    std::cerr << std::format("{} is not a session log", path) << std::endl;
+    ::close(fd);
+    return false;
+  }
+  void* mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (mapping == MAP_FAILED) {
+    std::cerr << std::format("Failed to map session log {}: {}", path, strerror(errno)) << std::endl;
+    return false;
+  }
+  madvise(mapping, st.st_size, MADV_SEQUENTIAL);
+  auto* candidate = static_cast<const LogFileHeader*>(mapping);
+  if (memcmp(candidate->magic, kLogMagic, sizeof(kLogMagic)) != 0 || candidate->version != kLogVersion) {
+    std::cerr << std::format("{} is not a session log", path) << std::endl;
+    munmap(mapping, st.st_size);
+    return false;
+  }
+  if (data)
+    munmap(const_cast<char*>(data), length);
+  data = static_cast<const char*>(mapping);
+  length = st.st_size;
+  header = candidate;
+  rewind();
+  return true;
+}
+
+void SessionLogReader::rewind() {
+  offset = sizeof(LogFileHeader);
+  cut = false;
+}
+
+bool SessionLogReader::next(LogRecord& record) {
+  for (;;) {
+    if (!data || offset + sizeof(LogRecordHeader) > length) {
+      cut = data && offset != length;
+      return false;
+    }
+    auto* h = reinterpret_cast<const LogRecordHeader*>(data + offset);
+    const char* payload = data + offset + sizeof(LogRecordHeader);
+    if (offset + sizeof(LogRecordHeader) + h->size > length) {
+      cut = true;
+      return false;
+    }
+    offset += sizeof(LogRecordHeader) + h->size;
+    record.type = h->type;
+    record.status = static_cast<ActionStatus>(h->status);
+    record.seq = h->seq;
+    record.timeNs = h->timeNs;
+    record.keypoints = nullptr;
+    // records of unknown type or size were written by a newer version, skip them
+    if (h->type == LogRecordType::Keypoints && h->size == sizeof(KeypointFrame)) {
+      record.keypoints = reinterpret_cast<const float*>(payload);
+      return true;
+    }
+    if (h->type == LogRecordType::Gesture && h->size == sizeof(LogGesture)) {
+      memcpy(&record.gesture, payload, sizeof(LogGesture));
+      return true;
+    }
+    if (h->type == LogRecordType::Action && h->size == sizeof(LogAction)) {
+      LogAction a;
+      memcpy(&a, payload, sizeof(a));
+      record.action = {a.action, record.status, a.emitNs};
+      return true;
+    }
+  }
+}
+}
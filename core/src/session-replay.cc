@@ -0,0 +1,75 @@
+#include <core/session-replay.h>
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <iostream>
+
+namespace core {
+ReplayAdapter::ReplayAdapter(ReplayOptions options) : options(std::move(options)) {
+}
+
+ReplayAdapter::~ReplayAdapter() noexcept {
+  running = false;
+  if (thread && thread->joinable())
+    thread->join();
+}
+
+bool ReplayAdapter::open(const std::string& path) {
+  if (!reader.open(path))
+    return false;
+  if (!options.reclassify)
+    return true;
+  if (!model.load(options.weights))
+    return false;
+  pipeline = std::make_unique<GesturePipeline>(model, options.detector);
+  return true;
+}
+
+void ReplayAdapter::start() {
+  thread = std::make_unique<std::thread>([this]() { inputAction(); });
+}
+
+bool ReplayAdapter::waitForRoom(int count) {
+  while (running.load(std::memory_order_relaxed) && buffer.size() + count > buffer.capacity())
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  return running.load(std::memory_order_relaxed);
+}
+
+void ReplayAdapter::inputAction() {
+  LogRecord record{};
+  int64_t firstNs = 0, replayStartNs = monotonicNs();
+  bool first = true;
+  while (running.load(std::memory_order_relaxed) && reader.next(record)) {
+    bool wanted = options.reclassify ? record.type == LogRecordType::Keypoints : record.type == LogRecordType::Action;
+    if (!wanted)
+      continue;
+    if (first) {
+      firstNs = record.timeNs;
+      first = false;
+    }
+    int64_t captureNs = monotonicNs();
+    if (options.speed > 0.0) {
+      captureNs = replayStartNs + static_cast<int64_t>(static_cast<double>(record.timeNs - firstNs) / options.speed);
+      // sleep in short steps so stop() is not held up by a long pause in the recording
+      for (int64_t now = monotonicNs(); now < captureNs && running.load(std::memory_order_relaxed);
+           now = monotonicNs())
+        std::this_thread::sleep_for(std::chrono::nanoseconds(std::min<int64_t>(captureNs - now, 10'000'000)));
+    }
+    if (!waitForRoom(options.reclassify ? GesturePipeline::kMaxActions : 1))
+      break;
+    if (options.reclassify) {
+      KeypointFrame frame;
+      std::copy_n(record.keypoints, kKeypointDim, frame.begin());
+      pipeline->push(frame, captureNs, buffer);
+    }
+    else {
+      ActionEvent event = record.action;
+      event.emitNs = monotonicNs();
+      buffer.tryPush(event, captureNs);
+    }
+  }
+  if (reader.truncated())
+    std::cerr << "Warning: session log ends in the middle of a record" << std::endl;
+  done.store(true, std::memory_order_release);
+}
+}
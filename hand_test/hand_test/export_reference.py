@@ -0,0 +1,71 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+# 用 TFLite 模型生成参考输出，给 C++ 推理做对拍
+# Run windows through the TFLite model and store inputs with the reference probabilities,
+# so that `gesture-infer --validate` can check core::GestureModel against TFLite.
+#
+# layout (little endian):
+#   char[4] "HGCR", uint32 count, uint32 window_size, uint32 num_classes
+#   count x (float32 window[window_size], float32 probabilities[num_classes])
+import argparse
+import struct
+
+import numpy as np
+
+from point_history_classifier import PointHistoryClassifier
+
+TIME_STEPS = 23
+DIMENSION = 42
+
+
+def normalize_hand_size(row, dimension=DIMENSION):
+    # copied from hand_side.py, which cannot be imported without opening the serial port
+    points = np.array(row)
+    ref_point = points[:2]
+    for i in range(0, dimension, 2):
+        points[i:i+2] -= ref_point
+    scale_factor = np.linalg.norm(points[34:36])
+    points /= scale_factor
+    return points.flatten()
+
+
+def random_windows(count, seed):
+    # random walks of a random hand, roughly what the device produces
+    rng = np.random.default_rng(seed)
+    windows = []
+    for _ in range(count):
+        hand = rng.uniform(0.2, 0.8, DIMENSION)
+        velocity = rng.normal(0, 0.01, DIMENSION)
+        frames = []
+        for _ in range(TIME_STEPS):
+            hand = hand + velocity + rng.normal(0, 0.002, DIMENSION)
+            frames.extend(normalize_hand_size(hand.copy()))
+        windows.append(np.array(frames, dtype=np.float32))
+    return windows
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--model', default='model/point_history_classifier/hand_classifier_v2.tflite')
+    parser.add_argument('--output', default='model/point_history_classifier/hand_classifier_v2.ref')
+    parser.add_argument('--count', type=int, default=256)
+    parser.add_argument('--seed', type=int, default=0)
+    args = parser.parse_args()
+
+    classifier = PointHistoryClassifier(model_path=args.model)
+    interpreter = classifier.interpreter
+    windows = random_windows(args.count, args.seed)
+    with open(args.output, 'wb') as out:
+        out.write(b'HGCR')
+        out.write(struct.pack('<3I', len(windows), TIME_STEPS * DIMENSION, 5))
+        for window in windows:
+            interpreter.set_tensor(classifier.input_details[0]['index'], np.array([window], dtype=np.float32))
+            interpreter.invoke()
+            result = np.squeeze(interpreter.get_tensor(classifier.output_details[0]['index']))
+            out.write(window.astype('<f4').tobytes())
+            out.write(result.astype('<f4').tobytes())
+    print('wrote', len(windows), 'reference windows to', args.output)
+
+
+if __name__ == '__main__':
+    main()
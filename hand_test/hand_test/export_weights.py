@@ -0,0 +1,76 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+# 把 training_hand_addnorm+2lstm.hdf5 里的权重导出成 C++ 推理用的平铺二进制文件
+# Export the weights of the addnorm + 2 LSTM model into the flat binary file read by core::GestureModel.
+# hand_classifier_v2.tflite was converted from this .hdf5, the weights are identical.
+#
+# layout (little endian):
+#   char[4] "HGCW", uint32 version = 1
+#   uint32 time_steps, input_dim, lstm1_units, lstm2_units, dense_units, num_classes
+#   float32 bn_epsilon
+#   float32 arrays: bn gamma, beta, moving_mean, moving_variance     (input_dim each)
+#                   lstm1 kernel (input_dim x 4u), recurrent (u x 4u), bias (4u)   gate order i, f, c, o
+#                   lstm2 kernel (u1 x 4u), recurrent (u x 4u), bias (4u)
+#                   dense1 kernel (u2 x dense_units), bias
+#                   dense2 kernel (dense_units x num_classes), bias
+import argparse
+import json
+import struct
+
+import h5py
+import numpy as np
+
+
+def layer_weights(group, layer_name):
+    weights = {}
+
+    def visit(name, obj):
+        if isinstance(obj, h5py.Dataset):
+            weights[name.split('/')[-1].split(':')[0]] = np.asarray(obj, dtype='<f4')
+
+    group[layer_name].visititems(visit)
+    return weights
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--hdf5', default='model/point_history_classifier/training_hand_addnorm+2lstm.hdf5')
+    parser.add_argument('--output', default='model/point_history_classifier/hand_classifier_v2.bin')
+    args = parser.parse_args()
+
+    f = h5py.File(args.hdf5, 'r')
+    config = json.loads(f.attrs['model_config'])
+    layers = {layer['class_name']: [] for layer in config['config']['layers']}
+    for layer in config['config']['layers']:
+        layers[layer['class_name']].append(layer['config'])
+
+    time_steps, input_dim = layers['Reshape'][0]['target_shape']
+    bn = layers['BatchNormalization'][0]
+    lstm1, lstm2 = layers['LSTM']
+    dense1, dense2 = layers['Dense']
+    assert lstm1['return_sequences'] and not lstm2['return_sequences']
+    assert dense1['activation'] == 'relu' and dense2['activation'] == 'softmax'
+
+    w = f['model_weights']
+    bn_w = layer_weights(w, bn['name'])
+    lstm1_w = layer_weights(w, lstm1['name'])
+    lstm2_w = layer_weights(w, lstm2['name'])
+    dense1_w = layer_weights(w, dense1['name'])
+    dense2_w = layer_weights(w, dense2['name'])
+
+    with open(args.output, 'wb') as out:
+        out.write(b'HGCW')
+        out.write(struct.pack('<7I', 1, time_steps, input_dim, lstm1['units'], lstm2['units'],
+                              dense1['units'], dense2['units']))
+        out.write(struct.pack('<f', bn['epsilon']))
+        for array in [bn_w['gamma'], bn_w['beta'], bn_w['moving_mean'], bn_w['moving_variance'],
+                      lstm1_w['kernel'], lstm1_w['recurrent_kernel'], lstm1_w['bias'],
+                      lstm2_w['kernel'], lstm2_w['recurrent_kernel'], lstm2_w['bias'],
+                      dense1_w['kernel'], dense1_w['bias'],
+                      dense2_w['kernel'], dense2_w['bias']]:
+            out.write(np.ascontiguousarray(array, dtype='<f4').tobytes())
+    print('wrote', args.output)
+
+
+if __name__ == '__main__':
+    main()